@@ -0,0 +1,221 @@
+/**
+ * @file   analytics_database.c
+ * @brief  Corpus analytics: index totals, top-N terms and top-N documents.
+ *
+ * Top-N queries make one pass over the dictionary (or the docTable) and
+ * keep the n best entries in a bounded min-heap, so they cost
+ * O(entries × log n) time and O(n) memory instead of a full sort or dump.
+ * Ties are broken by name, so the ranking is stable across runs.
+ *
+ * Term counts include the aliases of deduplicated documents, exactly as
+ * search results report them. Per-document token and distinct-term counts
+ * are gathered while each document is tokenized (create_database.c) and
+ * kept in its docEntry.
+ */
+
+#include "main.h"
+
+/* ── One ranked entry: its key, its name for ties, and what it is ── */
+typedef struct
+{
+    uint64_t    key;
+    const char *name;
+    void       *item;    /* mNode * or docEntry * */
+} rankItem;
+
+/* ── Min-heap of rankItems by (key, then reverse name order) ── */
+static int rank_less(const rankItem *a, const rankItem *b)
+{
+    if(a->key != b->key)
+        return a->key < b->key;
+    return strcmp(a->name, b->name) > 0;
+}
+
+static void rank_sift_down(rankItem *heap, u_int n, u_int i)
+{
+    while(1)
+    {
+        u_int l = 2 * i + 1, r = l + 1, min = i;
+        if(l < n && rank_less(&heap[l], &heap[min])) min = l;
+        if(r < n && rank_less(&heap[r], &heap[min])) min = r;
+        if(min == i)
+            return;
+        rankItem tmp = heap[i]; heap[i] = heap[min]; heap[min] = tmp;
+        i = min;
+    }
+}
+
+static void rank_sift_up(rankItem *heap, u_int i)
+{
+    while(i > 0 && rank_less(&heap[i], &heap[(i - 1) / 2]))
+    {
+        rankItem tmp = heap[i]; heap[i] = heap[(i - 1) / 2]; heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static int rank_desc_cmp(const void *a, const void *b)
+{
+    const rankItem *x = a, *y = b;
+    return rank_less(x, y) - rank_less(y, x);
+}
+
+/* ─────────────────────────────────────────────
+ *  rankHeap — The n best items seen so far
+ *  items[] grows by doubling up to n, so a large n
+ *  over a small index allocates only what it keeps.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    rankItem *items;
+    u_int     kept;
+    u_int     cap;
+    u_int     n;
+} rankHeap;
+
+static Status rank_offer(rankHeap *h, uint64_t key, const char *name, void *item)
+{
+    rankItem cand = { key, name, item };
+
+    if(h->kept < h->n)
+    {
+        if(h->kept == h->cap)
+        {
+            u_int     new_cap = h->cap ? h->cap * 2 : 64;
+            rankItem *grown;
+            if(new_cap > h->n)
+                new_cap = h->n;
+            grown = realloc(h->items, new_cap * sizeof(rankItem));
+            if(grown == NULL)
+                return FAILURE;
+            h->items = grown;
+            h->cap   = new_cap;
+        }
+        h->items[h->kept] = cand;
+        rank_sift_up(h->items, h->kept);
+        h->kept++;
+    }
+    else if(rank_less(&h->items[0], &cand))
+    {
+        h->items[0] = cand;
+        rank_sift_down(h->items, h->kept, 0);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief  Ranking key of a word: its occurrences or its files, each
+ *         posting counted once more per alias of its file.
+ */
+static uint64_t term_key(const mNode *node, const docTable *docs, TermRank by)
+{
+    uint64_t key = 0;
+
+    if(by == RANK_FILES && docs->naliases == 0)
+        return node->filecount;
+
+    for(sNode *sTemp = node->sLink; sTemp; sTemp = sTemp->subLink)
+    {
+        u_int copies = 1;
+        if(docs->naliases)
+        {
+            docEntry *d = dedup_entry(docs, sTemp->file_name);
+            if(d)
+                copies += d->naliases;
+        }
+        key += (by == RANK_FILES) ? copies : (uint64_t)sTemp->wordcount * copies;
+    }
+    return key;
+}
+
+/**
+ * @brief  Reports the n words with the most occurrences (RANK_TOTAL) or
+ *         the most files (RANK_FILES), best first.
+ *
+ * @param  fn   Receives each word's mNode in rank order; non-zero stops.
+ * @return SUCCESS, DATA_NOT_FOUND if the index is empty, FAILURE on
+ *         malloc failure.
+ */
+Status top_terms(hash_T *arr, const docTable *docs, TermRank by, u_int n,
+                 match_fn fn, void *ctx)
+{
+    rankHeap heap = { NULL, 0, 0, n };
+    Status   ret  = SUCCESS;
+
+    for(int i = 0; ret == SUCCESS && i < 27; i++)
+        for(mNode *mTemp = arr[i].link; ret == SUCCESS && mTemp; mTemp = mTemp->mLink)
+            ret = rank_offer(&heap, term_key(mTemp, docs, by), mTemp->word, mTemp);
+
+    if(ret == SUCCESS)
+    {
+        qsort(heap.items, heap.kept, sizeof(rankItem), rank_desc_cmp);
+        for(u_int i = 0; i < heap.kept; i++)
+        {
+            mNode *node = heap.items[i].item;
+            if(fn(&node, 1, 0, ctx))
+                break;
+        }
+        if(heap.kept == 0)
+            ret = DATA_NOT_FOUND;
+    }
+    free(heap.items);
+    return ret;
+}
+
+/**
+ * @brief  Reports the n indexed documents with the most distinct terms
+ *         (RANK_TERMS) or the most tokens (RANK_TOKENS), best first.
+ *
+ * Aliases are not ranked on their own; each is reported with its original.
+ *
+ * @return SUCCESS, DATA_NOT_FOUND if no document is recorded, FAILURE on
+ *         malloc failure.
+ */
+Status top_docs(const docTable *docs, DocRank by, u_int n, doc_fn fn, void *ctx)
+{
+    rankHeap heap = { NULL, 0, 0, n };
+    Status   ret  = SUCCESS;
+
+    for(u_int i = 0; ret == SUCCESS && i < docs->ndocs; i++)
+    {
+        docEntry *d = &docs->docs[i];
+        ret = rank_offer(&heap, by == RANK_TERMS ? d->nterms : d->ntokens, d->file_name, d);
+    }
+
+    if(ret == SUCCESS)
+    {
+        qsort(heap.items, heap.kept, sizeof(rankItem), rank_desc_cmp);
+        for(u_int i = 0; i < heap.kept; i++)
+            if(fn(heap.items[i].item, ctx))
+                break;
+        if(heap.kept == 0)
+            ret = DATA_NOT_FOUND;
+    }
+    free(heap.items);
+    return ret;
+}
+
+/**
+ * @brief  Counts the words, postings and tokens of the index.
+ *
+ * Aliases are not counted: they add no postings and no tokens.
+ */
+void corpus_stats(hash_T *arr, const docTable *docs, corpusStats *cs)
+{
+    memset(cs, 0, sizeof(*cs));
+    for(int i = 0; i < 27; i++)
+    {
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
+        {
+            cs->terms++;
+            cs->postings += mTemp->filecount;
+            for(sNode *sTemp = mTemp->sLink; sTemp; sTemp = sTemp->subLink)
+                cs->tokens += sTemp->wordcount;
+        }
+    }
+
+    cs->docs    = docs->ndocs;
+    cs->aliases = docs->naliases;
+    for(u_int i = 0; i < docs->ndocs; i++)
+        cs->bytes += docs->docs[i].len;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file   benchmark_ingest.c
+ * @brief  Compares the document readers inv_build can use (menu option 13).
+ *
+ * Every reader builds a scratch index of the same files, so the numbers
+ * include tokenizing and merging, not just I/O. An untimed warm-up build
+ * runs first, so every reader sees the same (warm) page cache; a cold run
+ * is where the batched readers gain the most.
+ *
+ * Where the kernel exposes hardware counters (perf_event_open), each build
+ * also reports its CPU cache misses, reader threads included. That is the
+ * number the dictionary layout (hash_t_utils.c) is tuned for.
+ */
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "cli.h"
+
+/* ── Files of the index, collected for the scratch builds ── */
+typedef struct
+{
+    char       **names;     /* strdup'd                                 */
+    unsigned int count;
+    unsigned int cap;
+    double       bytes;     /* On-disk size, compressed files as stored */
+    int          failed;
+} fileSet;
+
+static int collect_file(const char *file_name, void *ctx)
+{
+    fileSet    *set = ctx;
+    struct stat st;
+
+    if(set->count == set->cap)
+    {
+        unsigned int new_cap = set->cap ? set->cap * 2 : 64;
+        char       **grown   = realloc(set->names, new_cap * sizeof(char *));
+        if(grown == NULL)
+        {
+            set->failed = 1;
+            return 1;
+        }
+        set->names = grown;
+        set->cap   = new_cap;
+    }
+    set->names[set->count] = strdup(file_name);
+    if(set->names[set->count] == NULL)
+    {
+        set->failed = 1;
+        return 1;
+    }
+    set->count++;
+    if(stat(file_name, &st) == 0)
+        set->bytes += st.st_size;
+    return 0;
+}
+
+static void free_file_set(fileSet *set)
+{
+    for(unsigned int i = 0; i < set->count; i++)
+        free(set->names[i]);
+    free(set->names);
+}
+
+/**
+ * @brief  Opens a disabled cache-miss counter for this thread and the
+ *         threads it starts afterwards.
+ * @return The counter's descriptor, or -1 if the machine has none (VMs
+ *         often do not) or perf_event_paranoid forbids it.
+ */
+static int open_miss_counter(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled       = 1;
+    attr.inherit        = 1;    /* Count the reader threads too */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * @brief  Builds a scratch index of set's files with one reader.
+ * @param  misses  Receives the build's cache misses, or -1 if they could
+ *                 not be counted.
+ * @return Seconds taken by inv_build, or a negative value if the reader is
+ *         unavailable (-1) or the build failed (-2).
+ */
+static double timed_build(const fileSet *set, InvIngestMode mode, long long *misses)
+{
+    struct timespec start, end;
+    InvIndex       *scratch = inv_create();
+    double          secs    = -2;
+
+    if(scratch == NULL)
+        return secs;
+    for(unsigned int i = 0; i < set->count; i++)
+        inv_add_file(scratch, set->names[i]);
+
+    if(inv_set_ingest(scratch, mode, 0) != INV_SUCCESS)
+        secs = -1;
+    else
+    {
+        int counter = open_miss_counter();
+        if(counter >= 0)
+            ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        InvStatus ret = inv_build(scratch);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if(ret == INV_SUCCESS)
+            secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        if(counter >= 0)
+        {
+            ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+            if(read(counter, misses, sizeof(*misses)) != sizeof(*misses))
+                *misses = -1;
+            close(counter);
+        }
+    }
+    inv_destroy(scratch);
+    return secs;
+}
+
+/**
+ * @brief  Times inv_build of the index's files with each reader and prints
+ *         the throughput of each next to the serial loop's.
+ */
+void benchmark_ingest(InvIndex *idx)
+{
+    static const struct { InvIngestMode mode; const char *name; } readers[] = {
+        { INV_INGEST_SERIAL,  "serial"   },
+        { INV_INGEST_THREADS, "threads"  },
+        { INV_INGEST_URING,   "io_uring" }
+    };
+    fileSet   set = { NULL, 0, 0, 0, 0 };
+    long long misses;
+
+    inv_foreach_file(idx, collect_file, &set);
+    if(set.failed)
+    {
+        printf(BOLD_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+        free_file_set(&set);
+        return;
+    }
+    if(set.count == 0)
+    {
+        printf(H_YELLOW "[Info] : List is Empty\n" RESET);
+        return;
+    }
+
+    timed_build(&set, INV_INGEST_SERIAL, &misses);  /* Warm-up: fill the page cache */
+
+    printf(BG_BLUE "_________________________________________________________________________________\n" RESET);
+    printf("| %-10s | %-10s | %-12s | %-10s | %-12s | %-8s |\n",
+           "Reader", "Time (s)", "Files/s", "MB/s", "Cache misses", "Speedup");
+
+    double serial = 0;
+    for(unsigned int i = 0; i < sizeof(readers) / sizeof(readers[0]); i++)
+    {
+        misses = -1;
+        double secs = timed_build(&set, readers[i].mode, &misses);
+        if(secs == -1)
+        {
+            printf("| %-10s | " H_YELLOW "%-64s" RESET " |\n", readers[i].name, "not available on this system");
+            continue;
+        }
+        if(secs < 0)
+        {
+            printf("| %-10s | " H_RED "%-64s" RESET " |\n", readers[i].name, "build failed");
+            continue;
+        }
+        if(secs < 1e-6)
+            secs = 1e-6;
+        if(readers[i].mode == INV_INGEST_SERIAL)
+            serial = secs;
+
+        printf("| %-10s | %-10.4f | %-12.0f | %-10.2f | ", readers[i].name, secs,
+               set.count / secs, set.bytes / (1024 * 1024) / secs);
+        if(misses >= 0)
+            printf("%-12lld | ", misses);
+        else
+            printf("%-12s | ", "n/a");
+        if(serial > 0)
+            printf(H_GREEN "%7.2fx" RESET " |\n", serial / secs);
+        else
+            printf("%8s |\n", "-");
+    }
+    printf(BG_BLUE "_________________________________________________________________________________\n" RESET);
+    printf(H_CYAN "[Info] : %u file(s), %.2f MB, warm page cache\n" RESET,
+           set.count, set.bytes / (1024 * 1024));
+
+    free_file_set(&set);
+}
@@ -0,0 +1,38 @@
+/**
+ * @file   cli.h
+ * @brief  Shared header for the interactive menu (the library's client).
+ *
+ * The menu talks to the index only through invsearch.h; this header adds
+ * the terminal colours, the table-style export helpers, the ingestion
+ * benchmark and the statistics report it uses.
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "invsearch.h"
+#include "color.h"
+
+#define DB_FILE      "database.txt"     /* Human-readable table (option 5)   */
+#define IDX_FILE     "database.idx"     /* Reloadable index (inv_save)       */
+#define EXT_DB_FILE  "database_ext.txt" /* Output of the on-disk build       */
+#define TSV_FILE     "database.tsv"     /* TSV dump (option 14)              */
+#define JSONL_FILE   "database.jsonl"   /* JSON Lines dump (option 14)       */
+
+/* display_database.c */
+void      display_database(InvIndex *idx);
+
+/* save_database.c */
+InvStatus save_database(InvIndex *idx);
+
+/* benchmark_ingest.c */
+void      benchmark_ingest(InvIndex *idx);
+
+/* stats_database.c */
+void      show_stats(InvIndex *idx, unsigned int n);
+
+#endif /* CLI_H */
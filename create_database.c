@@ -2,12 +2,20 @@
  * @file   create_database.c
  * @brief  Builds the inverted index by reading each file word-by-word.
  *
- * For every word read from a file, this module:
+ * Indexing is done in two phases per file:
+ *   1. Every token is counted in a small per-file term table (lTable,
+ *      see ltable_utils.c) that stays cache-resident, so a word
+ *      repeated 1,000 times costs 1,000 cheap probes instead of 1,000
+ *      walks of the global bucket chain and sNode chain.
+ *   2. Once the file is fully read, the table is flushed into the global
+ *      hash table: one mNode lookup and one sNode per distinct term.
+ *
+ * For every distinct term the flush:
  *   1. Computes the hash bucket index from the first character.
- *   2. Searches the bucket's mNode chain for an existing entry.
- *   3. If found, increments the word count for the current file
+ *   2. Looks the word up in the bucket's directory by its hash.
+ *   3. If found, adds the term's count to the current file's sNode
  *      (or creates a new sNode if this is a new file for that word).
- *   4. If not found, creates a new mNode + sNode pair.
+ *   4. If not found, appends a new mNode + sNode pair to the chain.
  *
  * BUG FIX (v1.1): The outer while(mTemp) loop was missing a `break` after
  * a word match was found and handled. This caused an infinite loop whenever
@@ -17,143 +25,206 @@
 #include "main.h"
 
 /**
- * @brief  Reads all files in the Flist and indexes their words into the hash table.
+ * @brief  Merges one distinct term of a file into the global hash table.
  *
- * @param  arr   The 27-bucket hash table.
- * @param  head  Head of the Flist (files to index).
- * @return SUCCESS on completion, FAILURE if a file cannot be opened or malloc fails.
+ * The word is found through its bucket's directory (see hash_t_utils.c)
+ * using the hash the lTable already computed, so no chain is walked.
  */
-Status create_database(hash_T *arr, Flist *head)
+static Status flush_term(hash_T *arr, lTerm *term, const char *file_name)
 {
-    Flist *temp = head;
-    FILE  *fp;
+    hash_T *bucket = &arr[bucket_index(term->word)];
+    u_int   len    = strlen(term->word);
+    mNode  *node   = bucket_find(bucket, term->word, term->hash, len);
 
-    /* ── Iterate over each file in the linked list ── */
-    while(temp)
+    /* ── Word already exists in the index ── */
+    if(node)
     {
-        fp = fopen(temp->file_name, "r");
-        if(fp == NULL)
+        /* A file's terms are merged together, so a sub-node for the
+         * current file can only be the last one */
+        if(strcmp(node->sTail->file_name, file_name) == 0)
         {
-            printf(H_RED "[Error] : File Could Not Open\n" RESET);
-            return FAILURE;
+            /* Same file (re-indexed) → accumulate the count */
+            node->sTail->wordcount += term->count;
+            return SUCCESS;
         }
-        printf(BOLD_GREEN "[Info] : %s Opened Successfully\n" RESET, temp->file_name);
 
-        char input_word[1024];
+        /* Word is in a new file → add a new sNode */
+        sNode *new_subNode = malloc(sizeof(sNode));
+        if(new_subNode == NULL) return FAILURE;
 
-        /* ── Read the file one word at a time ── */
-        while(fscanf(fp, "%s", input_word) != EOF)
-        {
-            /* Strip punctuation from the token */
-            strip_punctuation(input_word);
+        new_subNode->wordcount  = term->count;
+        new_subNode->file_name  = strdup(file_name);
+        new_subNode->subLink    = NULL;
 
-            /* Skip tokens that were pure punctuation (e.g. "---" → "") */
-            if(input_word[0] == '\0')
-                continue;
+        node->sTail->subLink = new_subNode;
+        node->sTail          = new_subNode;
+        (node->filecount)++;
+        return SUCCESS;
+    }
 
-            /* Compute bucket index from the first character */
-            int index;
-            if(islower(input_word[0]))
-                index = input_word[0] - 'a';        /* a=0, b=1, ..., z=25 */
-            else if(isupper(input_word[0]))
-                index = input_word[0] - 'A';        /* A=0, B=1, ..., Z=25 */
-            else
-                index = 26;                          /* Non-alphabetic token */
-
-            /* ── Bucket is empty: create the first mNode + sNode ── */
-            if(arr[index].link == NULL)
-            {
-                mNode *new_mainNode = malloc(sizeof(mNode));
-                if(new_mainNode == NULL) return FAILURE;
+    /* ── Word not found in bucket: create a new mNode + sNode ── */
+    sNode *new_subNode = malloc(sizeof(sNode));
+    if(new_subNode == NULL) return FAILURE;
 
-                sNode *new_subNode = malloc(sizeof(sNode));
-                if(new_subNode == NULL) { free(new_mainNode); return FAILURE; }
+    node = bucket_append(bucket, term->word, term->hash, len);
+    if(node == NULL) { free(new_subNode); return FAILURE; }
 
-                new_mainNode->filecount = 1;
-                new_mainNode->word      = strdup(input_word);
-                new_mainNode->sLink     = new_subNode;
-                new_mainNode->mLink     = NULL;
+    new_subNode->file_name  = strdup(file_name);
+    new_subNode->wordcount  = term->count;
+    new_subNode->subLink    = NULL;
 
-                new_subNode->file_name  = strdup(temp->file_name);
-                new_subNode->wordcount  = 1;
-                new_subNode->subLink    = NULL;
+    node->filecount = 1;
+    node->sLink     = node->sTail = new_subNode;
+    return SUCCESS;
+}
 
-                arr[index].link = new_mainNode;
-            }
-            else
+/**
+ * @brief  Indexes the files of the Flist, keeping only the terms whose
+ *         hash_word() % nparts == part.
+ *
+ * Documents come from an ingestReader (ingest_utils.c), which keeps up to
+ * depth of them being opened and read while earlier ones are counted and
+ * merged. They still arrive in Flist order, so the index is the same for
+ * every mode.
+ *
+ * @param  docs  If not NULL, a document byte-identical to one in docs
+ *               is recorded as its alias instead of being indexed, and
+ *               every newly indexed document is added to it together
+ *               with its token and distinct-term counts.
+ * @param  done  If not NULL, receives the last file fully merged (left
+ *               unchanged if none was).
+ */
+static Status index_files(hash_T *arr, Flist *head, u_int nparts, u_int part,
+                          IngestMode mode, u_int depth, docTable *docs, Flist **done)
+{
+    lTable  local;
+    Status  ret = SUCCESS;
+
+    if(head == NULL)
+        return SUCCESS;
+    if(ltable_init(&local) == FAILURE)
+        return FAILURE;
+
+    ingestReader *reader = ingest_open(head, mode, depth, docs != NULL);
+    if(reader == NULL)
+    {
+        ltable_free(&local);
+        return FAILURE;
+    }
+
+    /* ── Iterate over each file in the linked list ── */
+    Flist   *temp;
+    FILE    *fp;
+    uint64_t hash = 0;
+    size_t   len  = 0, buf_len;
+    while(ret == SUCCESS && (fp = ingest_next(reader, &temp)) != NULL)
+    {
+        char input_word[WORD_BUF_SIZE];
+
+        /* ── A verified copy of an indexed document only becomes its alias ──
+         * A batched document's hash is known before it is tokenized */
+        const char *original = NULL;
+        int         hashed   = docs && ingest_hash(reader, &hash, &len) == SUCCESS;
+        if(hashed)
+        {
+            const char *buf = ingest_buffer(reader, &buf_len);
+            original = dedup_find(docs, hash, len, temp->file_name, buf);
+        }
+        if(original)
+        {
+            fclose(fp);
+            ret = dedup_alias(docs, original, temp->file_name);
+            if(ret == SUCCESS && done)
+                *done = temp;
+            continue;
+        }
+
+        /* ── Phase 1: count every token in the per-file table ── */
+        u_int ntokens = 0;
+        while(ret == SUCCESS && next_token(fp, input_word))
+        {
+            ret = ltable_add(&local, input_word);
+            ntokens++;
+        }
+        u_int nterms = local.nterms;
+        if(ferror(fp))
+            ret = FAILURE;                  /* Read or decompression error */
+        if(fclose(fp) != 0)
+            ret = FAILURE;
+
+        /* A streamed document's hash is known only now that it was read */
+        if(ret == SUCCESS && docs && !hashed)
+        {
+            if(ingest_hash(reader, &hash, &len) == FAILURE)
+                ret = FAILURE;
+            else if((original = dedup_find(docs, hash, len, temp->file_name,
+                                           ingest_buffer(reader, &buf_len))) != NULL)
             {
-                /* ── Bucket has entries: search the mNode chain ── */
-                mNode *mTemp = arr[index].link, *mPrev = NULL;
-
-                while(mTemp)
-                {
-                    /* ── Word already exists in the index ── */
-                    if(strcmp(mTemp->word, input_word) == 0)
-                    {
-                        /* Search for a sub-node matching the current file */
-                        sNode *sTemp = mTemp->sLink, *sPrev = NULL;
-                        while(sTemp)
-                        {
-                            if(strcmp(sTemp->file_name, temp->file_name) == 0)
-                            {
-                                /* Same file → just increment the count */
-                                (sTemp->wordcount)++;
-                                break;
-                            }
-                            sPrev = sTemp;
-                            sTemp = sTemp->subLink;
-                        }
-
-                        /* Word is in a new file → add a new sNode */
-                        if(sTemp == NULL)
-                        {
-                            sNode *new_subNode = malloc(sizeof(sNode));
-                            if(new_subNode == NULL) return FAILURE;
-
-                            new_subNode->wordcount  = 1;
-                            new_subNode->file_name  = strdup(temp->file_name);
-                            new_subNode->subLink    = NULL;
-
-                            sPrev->subLink = new_subNode;
-                            (mTemp->filecount)++;
-                        }
-
-                        /* FIX: break the outer loop — word is handled */
-                        break;
-                    }
-                    else
-                    {
-                        mPrev = mTemp;
-                        mTemp = mTemp->mLink;
-                    }
-                }
-
-                /* ── Word not found in bucket: create a new mNode + sNode ── */
-                if(mTemp == NULL)
-                {
-                    mNode *new_mainNode = malloc(sizeof(mNode));
-                    if(new_mainNode == NULL) return FAILURE;
-
-                    sNode *new_subNode = malloc(sizeof(sNode));
-                    if(new_subNode == NULL) { free(new_mainNode); return FAILURE; }
-
-                    new_mainNode->filecount = 1;
-                    new_mainNode->word      = strdup(input_word);
-                    new_mainNode->sLink     = new_subNode;
-                    new_mainNode->mLink     = NULL;
-
-                    new_subNode->file_name  = strdup(temp->file_name);
-                    new_subNode->wordcount  = 1;
-                    new_subNode->subLink    = NULL;
-
-                    mPrev->mLink = new_mainNode;
-                }
+                ltable_reset(&local);
+                ret = dedup_alias(docs, original, temp->file_name);
+                if(ret == SUCCESS && done)
+                    *done = temp;
+                continue;
             }
         }
 
-        fclose(fp);
-        temp = temp->link;
+        /* ── Phase 2: one global merge per distinct term ── */
+        for(u_int i = 0; ret == SUCCESS && i < local.nterms; i++)
+        {
+            if(local.terms[i].hash % nparts != part)
+                continue;
+            ret = flush_term(arr, &local.terms[i], temp->file_name);
+        }
+        ltable_reset(&local);
+
+        /* Recorded only once merged, so a failed file is retried as new */
+        if(ret == SUCCESS && docs)
+            ret = dedup_add(docs, hash, len, temp->file_name, ntokens, nterms);
+        if(ret == SUCCESS && done)
+            *done = temp;
     }
 
-    return SUCCESS;
-}
\ No newline at end of file
+    /* A file that could not be opened or read ends the loop early */
+    if(ingest_close(reader) == FAILURE)
+        ret = FAILURE;
+    ltable_free(&local);
+    return ret;
+}
+
+/**
+ * @brief  Reads all files in the Flist and indexes their words into the hash table.
+ *
+ * @param  arr   The 27-bucket hash table.
+ * @param  head  Head of the Flist (files to index).
+ * @param  mode  How documents are read (INGEST_AUTO picks the fastest).
+ * @param  depth Documents in flight (0 = INGEST_DEPTH).
+ * @param  docs  If not NULL, byte-identical copies of documents in docs
+ *               (or earlier in head) are recorded there as aliases and
+ *               not indexed again.
+ * @param  done  If not NULL, receives the last file fully merged, so a
+ *               failed build can be resumed after it.
+ * @return SUCCESS on completion, FAILURE if a file cannot be read or malloc fails.
+ */
+Status create_database(hash_T *arr, Flist *head, IngestMode mode, u_int depth,
+                       docTable *docs, Flist **done)
+{
+    return index_files(arr, head, 1, 0, mode, depth, docs, done);
+}
+
+/**
+ * @brief  Indexes only the terms whose hash_word() % nparts == part.
+ *
+ * Used by term-partitioned shards (shard_database.c): every shard reads
+ * every file but keeps a disjoint slice of the vocabulary.
+ *
+ * @param  arr     The 27-bucket hash table of this partition.
+ * @param  head    Head of the Flist (files to index).
+ * @param  nparts  Number of partitions (1 = keep every term).
+ * @param  part    Partition kept by this call, 0 .. nparts - 1.
+ * @return SUCCESS on completion, FAILURE if a file cannot be read or malloc fails.
+ */
+Status create_database_part(hash_T *arr, Flist *head, u_int nparts, u_int part)
+{
+    /* Shards already read in parallel, one thread each */
+    return index_files(arr, head, nparts, part, INGEST_SERIAL, 1, NULL, NULL);
+}
@@ -0,0 +1,257 @@
+/**
+ * @file   dedup_utils.c
+ * @brief  Content-addressed table of indexed documents (docTable).
+ *
+ * Every document inv_build indexes is recorded under its content hash
+ * (hash_bytes) and size. A later document with the same hash and size is
+ * a candidate copy; it is compared byte for byte with the indexed one,
+ * and only if they are identical is it recorded as an alias of the first
+ * copy instead of being indexed. Search results list an alias next to
+ * its original with the same counts. A hash collision between distinct
+ * documents therefore costs one extra read, never a wrong posting.
+ *
+ * Each entry also carries the token and distinct-term counts of its
+ * document, gathered while it was tokenized, for the corpus analytics
+ * (analytics_database.c).
+ *
+ */
+
+#include "main.h"
+
+#define DOCTABLE_INIT_CAP 64    /* Documents before the first grow */
+#define DEDUP_CMP_CHUNK   8192  /* Bytes compared per read          */
+
+/* (hash, len) → probe start; len is mixed in so equal hashes of
+ * different sizes spread apart */
+static uint64_t content_key(uint64_t hash, size_t len)
+{
+    return hash ^ (len * 0x9E3779B97F4A7C15ULL);
+}
+
+static void probe_insert(u_int *slots, u_int mask, uint64_t key, u_int pos1)
+{
+    u_int pos = key & mask;
+    while(slots[pos])
+        pos = (pos + 1) & mask;
+    slots[pos] = pos1;
+}
+
+/**
+ * @brief  Doubles the table and rebuilds both probe tables.
+ */
+static Status doc_grow(docTable *dt)
+{
+    u_int     new_cap  = dt->cap ? dt->cap * 2 : DOCTABLE_INIT_CAP;
+    u_int     mask     = 2 * new_cap - 1;
+    docEntry *new_docs = realloc(dt->docs, new_cap * sizeof(docEntry));
+    if(new_docs == NULL)
+        return FAILURE;
+    dt->docs = new_docs;
+
+    u_int *by_content = calloc(2 * new_cap, sizeof(u_int));
+    u_int *by_name    = calloc(2 * new_cap, sizeof(u_int));
+    if(by_content == NULL || by_name == NULL)
+    {
+        free(by_content);
+        free(by_name);
+        return FAILURE;
+    }
+
+    for(u_int i = 0; i < dt->ndocs; i++)
+    {
+        docEntry *d = &dt->docs[i];
+        probe_insert(by_content, mask, content_key(d->hash, d->len), i + 1);
+        probe_insert(by_name, mask, hash_word(d->file_name), i + 1);
+    }
+
+    free(dt->by_content);
+    free(dt->by_name);
+    dt->by_content = by_content;
+    dt->by_name    = by_name;
+    dt->cap        = new_cap;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Whether the document `orig` has exactly the given content.
+ *
+ * @param  file_name  The new document, re-read when buf is NULL.
+ * @param  buf, len   The new document's bytes, if held in memory.
+ * @return 1 if identical, 0 if not or if either document cannot be read.
+ */
+static int same_content(const char *orig, const char *file_name, const char *buf, size_t len)
+{
+    char   a[DEDUP_CMP_CHUNK], b[DEDUP_CMP_CHUNK];
+    FILE  *fa   = open_document(orig);
+    FILE  *fb   = buf ? NULL : open_document(file_name);
+    int    same = fa != NULL && (buf || fb != NULL);
+    size_t off  = 0;
+
+    while(same)
+    {
+        size_t      n = fread(a, 1, sizeof(a), fa);
+        size_t      m;
+        const char *p = b;
+        if(buf)
+        {
+            m = (len - off < sizeof(a)) ? len - off : sizeof(a);
+            p = buf + off;
+        }
+        else
+            m = fread(b, 1, sizeof(b), fb);
+
+        if(n != m || memcmp(a, p, n) != 0 || ferror(fa) || (fb && ferror(fb)))
+            same = 0;
+        else if(n == 0)
+            break;
+        off += n;
+    }
+
+    if(fa)
+        fclose(fa);
+    if(fb)
+        fclose(fb);
+    return same;
+}
+
+/**
+ * @brief  Name of the indexed document that file_name is a copy of, if any.
+ *
+ * Every indexed document with the same hash and size is compared with
+ * the new one byte for byte; the first identical one is returned.
+ *
+ * @param  buf  The new document's bytes (len of them) if it is held in
+ *              memory, or NULL to re-read file_name.
+ */
+const char *dedup_find(const docTable *dt, uint64_t hash, size_t len,
+                       const char *file_name, const char *buf)
+{
+    if(dt->cap == 0)
+        return NULL;
+
+    u_int mask = 2 * dt->cap - 1;
+    for(u_int pos = content_key(hash, len) & mask; dt->by_content[pos]; pos = (pos + 1) & mask)
+    {
+        docEntry *d = &dt->docs[dt->by_content[pos] - 1];
+        if(d->hash == hash && d->len == len && same_content(d->file_name, file_name, buf, len))
+            return d->file_name;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Records an indexed document.
+ *
+ * Its content is not looked up: a copy found with dedup_find is recorded
+ * with dedup_alias instead.
+ *
+ * @param  ntokens, nterms  Token and distinct-term counts of the document.
+ * @return SUCCESS, or FAILURE on malloc failure.
+ */
+Status dedup_add(docTable *dt, uint64_t hash, size_t len, const char *file_name,
+                 u_int ntokens, u_int nterms)
+{
+    if(2 * (dt->ndocs + 1) > dt->cap && doc_grow(dt) == FAILURE)
+        return FAILURE;
+
+    char *name = strdup(file_name);
+    if(name == NULL)
+        return FAILURE;
+
+    u_int     mask = 2 * dt->cap - 1;
+    docEntry *d    = &dt->docs[dt->ndocs++];
+    d->hash      = hash;
+    d->len       = len;
+    d->file_name = name;
+    d->aliases   = d->last = NULL;
+    d->naliases  = 0;
+    d->ntokens   = ntokens;
+    d->nterms    = nterms;
+    probe_insert(dt->by_content, mask, content_key(hash, len), dt->ndocs);
+    probe_insert(dt->by_name, mask, hash_word(name), dt->ndocs);
+    return SUCCESS;
+}
+
+/**
+ * @brief  Records file_name as a copy of the indexed document original.
+ *
+ * The alias shares its original's postings and counts.
+ *
+ * @return SUCCESS, or FAILURE if original is not an indexed document or
+ *         malloc fails.
+ */
+Status dedup_alias(docTable *dt, const char *original, const char *file_name)
+{
+    docEntry *d = dedup_entry(dt, original);
+    if(d == NULL)
+        return FAILURE;
+
+    Flist *alias = malloc(sizeof(Flist));
+    if(alias == NULL)
+        return FAILURE;
+    alias->file_name = strdup(file_name);
+    alias->link      = NULL;
+    if(alias->file_name == NULL)
+    {
+        free(alias);
+        return FAILURE;
+    }
+
+    if(d->last)
+        d->last->link = alias;
+    else
+        d->aliases = alias;
+    d->last = alias;
+    (d->naliases)++;
+    (dt->naliases)++;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Entry of the indexed document with this name (not an alias).
+ * @return The entry, or NULL if file_name is not in the table.
+ */
+docEntry *dedup_entry(const docTable *dt, const char *file_name)
+{
+    if(dt->cap == 0)
+        return NULL;
+
+    u_int mask = 2 * dt->cap - 1;
+    for(u_int pos = hash_word(file_name) & mask; dt->by_name[pos]; pos = (pos + 1) & mask)
+    {
+        docEntry *d = &dt->docs[dt->by_name[pos] - 1];
+        if(strcmp(d->file_name, file_name) == 0)
+            return d;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Aliases of an indexed document, in the order they were added.
+ * @return The first alias, or NULL if it has none (or is not in the table).
+ */
+const Flist *dedup_aliases(const docTable *dt, const char *file_name)
+{
+    if(dt->naliases == 0)
+        return NULL;
+
+    docEntry *d = dedup_entry(dt, file_name);
+    return d ? d->aliases : NULL;
+}
+
+/**
+ * @brief  Frees every entry and resets the table to empty.
+ */
+void dedup_free(docTable *dt)
+{
+    for(u_int i = 0; i < dt->ndocs; i++)
+    {
+        free(dt->docs[i].file_name);
+        if(dt->docs[i].aliases)
+            free_list(&dt->docs[i].aliases);
+    }
+    free(dt->docs);
+    free(dt->by_content);
+    free(dt->by_name);
+    memset(dt, 0, sizeof(*dt));
+}
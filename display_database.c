@@ -1,6 +1,42 @@
-#include "main.h"
+/**
+ * @file   display_database.c
+ * @brief  Prints the whole index as a colored table (menu option 2).
+ */
 
-void display_database(hash_T *arr)
+#include "cli.h"
+
+#define FILES_COL_WIDTH 40
+
+/**
+ * @brief  Prints the postings' file names, comma-separated, padded to
+ *         the Filenames column. Long lists simply widen the row.
+ */
+static void print_files(FILE *fp, const InvHit *hit)
+{
+    int width = 0;
+    for(unsigned int i = 0; i < hit->filecount; i++)
+        width += fprintf(fp, "%s%s", hit->postings[i].file_name, i + 1 < hit->filecount ? ", " : "");
+    if(width < FILES_COL_WIDTH)
+        fprintf(fp, "%*s", FILES_COL_WIDTH - width, "");
+}
+
+static int print_row(const InvHit *hit, void *ctx)
+{
+    (void)ctx;
+
+    // Data Row
+    printf(H_CYAN "|" RESET " " H_YELLOW "%-10u" RESET 
+           H_CYAN " |" RESET " " H_GREEN "%-15s" RESET 
+           H_CYAN " |" RESET " %-10u " 
+           H_CYAN "|" RESET " %-10u " 
+           H_CYAN "|" RESET " " H_MAGENTA,
+           hit->bucket, hit->word, hit->filecount, hit->total);
+    print_files(stdout, hit);
+    printf(RESET H_CYAN "|\n" RESET);
+    return 0;
+}
+
+void display_database(InvIndex *idx)
 {
     // Top Border
     printf(H_CYAN "+------------+-----------------+------------+------------+------------------------------------------+\n" RESET);
@@ -17,34 +53,7 @@ void display_database(hash_T *arr)
     // Header-Separator
     printf(H_CYAN "+------------+-----------------+------------+------------+------------------------------------------+\n" RESET);
 
-    for (int i = 0; i < 27; i++)
-    {
-        mNode *mTemp = arr[i].link;
-        while (mTemp)
-        {
-            char all_files[1024] = ""; 
-            u_int total_word_count = 0;
-            sNode *sTemp = mTemp->sLink;
-
-            while (sTemp)
-            {
-                total_word_count += sTemp->wordcount;
-                strcat(all_files, sTemp->file_name);
-                if (sTemp->subLink) strcat(all_files, ", ");
-                sTemp = sTemp->subLink;
-            }
-
-            // Data Row
-            printf(H_CYAN "|" RESET " " H_YELLOW "%-10d" RESET 
-                   H_CYAN " |" RESET " " H_GREEN "%-15s" RESET 
-                   H_CYAN " |" RESET " %-10u " 
-                   H_CYAN "|" RESET " %-10u " 
-                   H_CYAN "|" RESET " " H_MAGENTA "%-40s" RESET 
-                   H_CYAN "|\n" RESET, 
-                   i, mTemp->word, mTemp->filecount, total_word_count, all_files);
-
-            mTemp = mTemp->mLink;
-        }
-    }
+    inv_foreach_term(idx, print_row, NULL);
+
     printf(H_CYAN "+------------+-----------------+------------+------------+------------------------------------------+\n" RESET);
-}
\ No newline at end of file
+}
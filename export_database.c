@@ -0,0 +1,491 @@
+/**
+ * @file   export_database.c
+ * @brief  Streams the whole index to a file as a table, TSV or JSONL.
+ *
+ * The bucket chains are cut into segments of up to EXPORT_SEG_TERMS
+ * words. Worker threads format segments into private memory buffers with
+ * plain byte appends (no printf), and the calling thread writes finished
+ * buffers to the file in index order, one large fwrite each. At most
+ * `window` segments are formatted ahead of the writer, so memory stays
+ * bounded however large the index is, and the output is identical
+ * whatever the thread count.
+ *
+ * Formats (one record per word unless noted):
+ *   EXPORT_TABLE  The database.txt layout: | bucket | word | files | total | names |
+ *   EXPORT_TSV    One "word<TAB>file<TAB>count" line per posting, with a
+ *                 header line; \t, \n, \r and \\ in names are escaped.
+ *   EXPORT_JSONL  {"word":…,"bucket":…,"filecount":…,"total":…,
+ *                  "postings":[{"file":…,"count":…},…]}
+ *
+ * Aliases of deduplicated documents (dedup_utils.c) are expanded next to
+ * their original, exactly as search results show them.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "main.h"
+
+#define EXPORT_SEG_TERMS    2048    /* Words formatted per segment        */
+#define EXPORT_MAX_THREADS  8       /* Formatting threads                 */
+#define EXPORT_FILES_WIDTH  40      /* Table: Filenames column width      */
+
+#define TABLE_RULE "____________________________________________________________________________________________________\n"
+
+/* ─────────────────────────────────────────────
+ *  exportSeg / exportBuf — Work items and their output
+ *  Segment k is formatted into bufs[k % window].
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    mNode *first;       /* First word of the segment       */
+    u_int  nterms;      /* Words, following mLink          */
+} exportSeg;
+
+typedef struct
+{
+    char       *data;
+    size_t      len;
+    size_t      cap;
+    InvPosting *posts;  /* Scratch: one word's postings    */
+    u_int       pcap;
+    u_int       seg;    /* Segment held ((u_int)-1 = none) */
+    int         ready;  /* Formatted, waiting for writer   */
+    int         failed; /* Ran out of memory               */
+} exportBuf;
+
+typedef struct
+{
+    const docTable *docs;
+    ExportFormat    fmt;
+    exportSeg      *segs;
+    u_int           nsegs;
+    exportBuf      *bufs;
+    u_int           window;
+    u_int           claim;      /* Next segment to format           */
+    u_int           written;    /* Segments the writer has finished */
+    int             stop;
+    pthread_mutex_t lock;
+    pthread_cond_t  formatted;  /* Writer: a segment is ready       */
+    pthread_cond_t  freed;      /* Workers: a buffer was written    */
+} exportJob;
+
+/* ─────────────────────────────────────────────
+ *  Buffer appends
+ * ───────────────────────────────────────────── */
+
+static int buf_reserve(exportBuf *b, size_t n)
+{
+    if(b->len + n <= b->cap)
+        return 1;
+
+    size_t new_cap = b->cap ? b->cap : 64 * 1024;
+    while(new_cap < b->len + n)
+        new_cap *= 2;
+    char *grown = realloc(b->data, new_cap);
+    if(grown == NULL)
+    {
+        b->failed = 1;
+        return 0;
+    }
+    b->data = grown;
+    b->cap  = new_cap;
+    return 1;
+}
+
+static void buf_put(exportBuf *b, const char *s, size_t n)
+{
+    if(buf_reserve(b, n))
+    {
+        memcpy(b->data + b->len, s, n);
+        b->len += n;
+    }
+}
+
+static void buf_puts(exportBuf *b, const char *s)
+{
+    buf_put(b, s, strlen(s));
+}
+
+static void buf_pad(exportBuf *b, size_t n)
+{
+    if(buf_reserve(b, n))
+    {
+        memset(b->data + b->len, ' ', n);
+        b->len += n;
+    }
+}
+
+static size_t buf_putu(exportBuf *b, u_int v)
+{
+    char  tmp[16];
+    char *p = tmp + sizeof(tmp);
+
+    do
+        *--p = '0' + v % 10;
+    while(v /= 10);
+    buf_put(b, p, tmp + sizeof(tmp) - p);
+    return tmp + sizeof(tmp) - p;
+}
+
+/* Left-aligned in a field of width (printf "%-Ns" / "%-Nu") */
+static void buf_put_left(exportBuf *b, const char *s, size_t width)
+{
+    size_t n = strlen(s);
+    buf_put(b, s, n);
+    if(n < width)
+        buf_pad(b, width - n);
+}
+
+static void buf_putu_left(exportBuf *b, u_int v, size_t width)
+{
+    size_t n = buf_putu(b, v);
+    if(n < width)
+        buf_pad(b, width - n);
+}
+
+static void buf_put_tsv(exportBuf *b, const char *s)
+{
+    for(; *s; s++)
+    {
+        switch(*s)
+        {
+            case '\t': buf_put(b, "\\t", 2);  break;
+            case '\n': buf_put(b, "\\n", 2);  break;
+            case '\r': buf_put(b, "\\r", 2);  break;
+            case '\\': buf_put(b, "\\\\", 2); break;
+            default:   buf_put(b, s, 1);      break;
+        }
+    }
+}
+
+static void buf_put_json(exportBuf *b, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    buf_put(b, "\"", 1);
+    for(; *s; s++)
+    {
+        unsigned char c = *s;
+        if(c == '"' || c == '\\')
+        {
+            char esc[2] = { '\\', c };
+            buf_put(b, esc, 2);
+        }
+        else if(c < 0x20)
+        {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            buf_put(b, esc, 6);
+        }
+        else
+            buf_put(b, s, 1);
+    }
+    buf_put(b, "\"", 1);
+}
+
+/* ─────────────────────────────────────────────
+ *  Formatting
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Collects a word's postings into b->posts, each file followed
+ *         by its aliases.
+ * @return Number of postings (0 after an allocation failure).
+ */
+static u_int gather_postings(exportBuf *b, const mNode *node, const docTable *docs)
+{
+    u_int n = 0;
+
+    for(sNode *sTemp = node->sLink; sTemp; sTemp = sTemp->subLink)
+    {
+        const Flist *alias = docs ? dedup_aliases(docs, sTemp->file_name) : NULL;
+        const char  *name  = sTemp->file_name;
+        while(name)
+        {
+            if(n == b->pcap)
+            {
+                u_int       new_cap = b->pcap ? b->pcap * 2 : 16;
+                InvPosting *grown   = realloc(b->posts, new_cap * sizeof(InvPosting));
+                if(grown == NULL)
+                {
+                    b->failed = 1;
+                    return 0;
+                }
+                b->posts = grown;
+                b->pcap  = new_cap;
+            }
+            b->posts[n].file_name = name;
+            b->posts[n].count     = sTemp->wordcount;
+            n++;
+
+            name  = alias ? alias->file_name : NULL;
+            alias = alias ? alias->link : NULL;
+        }
+    }
+    return n;
+}
+
+static void format_word(exportBuf *b, const mNode *node, const docTable *docs, ExportFormat fmt)
+{
+    u_int n     = gather_postings(b, node, docs);
+    u_int total = 0;
+
+    for(u_int i = 0; i < n; i++)
+        total += b->posts[i].count;
+
+    switch(fmt)
+    {
+        case EXPORT_TABLE:
+        {
+            size_t width = 0;
+            buf_puts(b, "| ");
+            buf_putu_left(b, bucket_index(node->word), 10);
+            buf_puts(b, " | ");
+            buf_put_left(b, node->word, 15);
+            buf_puts(b, " | ");
+            buf_putu_left(b, n, 10);
+            buf_puts(b, " | ");
+            buf_putu_left(b, total, 10);
+            buf_puts(b, " | ");
+            for(u_int i = 0; i < n; i++)
+            {
+                if(i)
+                    buf_put(b, ", ", 2);
+                buf_puts(b, b->posts[i].file_name);
+                width += strlen(b->posts[i].file_name) + (i ? 2 : 0);
+            }
+            if(width < EXPORT_FILES_WIDTH)
+                buf_pad(b, EXPORT_FILES_WIDTH - width);
+            buf_puts(b, " |\n");
+            break;
+        }
+
+        case EXPORT_TSV:
+        {
+            for(u_int i = 0; i < n; i++)
+            {
+                buf_put_tsv(b, node->word);
+                buf_put(b, "\t", 1);
+                buf_put_tsv(b, b->posts[i].file_name);
+                buf_put(b, "\t", 1);
+                buf_putu(b, b->posts[i].count);
+                buf_put(b, "\n", 1);
+            }
+            break;
+        }
+
+        case EXPORT_JSONL:
+        {
+            buf_puts(b, "{\"word\":");
+            buf_put_json(b, node->word);
+            buf_puts(b, ",\"bucket\":");
+            buf_putu(b, bucket_index(node->word));
+            buf_puts(b, ",\"filecount\":");
+            buf_putu(b, n);
+            buf_puts(b, ",\"total\":");
+            buf_putu(b, total);
+            buf_puts(b, ",\"postings\":[");
+            for(u_int i = 0; i < n; i++)
+            {
+                buf_puts(b, i ? ",{\"file\":" : "{\"file\":");
+                buf_put_json(b, b->posts[i].file_name);
+                buf_puts(b, ",\"count\":");
+                buf_putu(b, b->posts[i].count);
+                buf_put(b, "}", 1);
+            }
+            buf_puts(b, "]}\n");
+            break;
+        }
+    }
+}
+
+static void format_segment(exportJob *job, u_int k, exportBuf *b)
+{
+    const mNode *node = job->segs[k].first;
+
+    b->len = 0;
+    for(u_int i = 0; i < job->segs[k].nterms && !b->failed; i++, node = node->mLink)
+        format_word(b, node, job->docs, job->fmt);
+}
+
+/* ─────────────────────────────────────────────
+ *  Formatting threads
+ * ───────────────────────────────────────────── */
+
+static void *export_worker(void *arg)
+{
+    exportJob *job = arg;
+
+    while(1)
+    {
+        pthread_mutex_lock(&job->lock);
+        while(!job->stop && job->claim < job->nsegs && job->claim >= job->written + job->window)
+            pthread_cond_wait(&job->freed, &job->lock);
+        if(job->stop || job->claim >= job->nsegs)
+        {
+            pthread_mutex_unlock(&job->lock);
+            return NULL;
+        }
+        u_int      k = job->claim++;
+        exportBuf *b = &job->bufs[k % job->window];
+        b->seg   = k;
+        b->ready = 0;
+        pthread_mutex_unlock(&job->lock);
+
+        /* bufs[k % window] is free: segment k - window was written */
+        format_segment(job, k, b);
+
+        pthread_mutex_lock(&job->lock);
+        b->ready = 1;
+        pthread_cond_signal(&job->formatted);
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+/**
+ * @brief  Cuts the bucket chains into segments of up to EXPORT_SEG_TERMS.
+ */
+static Status split_segments(hash_T *arr, exportJob *job)
+{
+    u_int cap = 0;
+
+    for(int i = 0; i < 27; i++)
+    {
+        u_int n = 0;
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
+        {
+            if(n == 0)
+            {
+                if(job->nsegs == cap)
+                {
+                    u_int      new_cap = cap ? cap * 2 : 64;
+                    exportSeg *grown   = realloc(job->segs, new_cap * sizeof(exportSeg));
+                    if(grown == NULL)
+                        return FAILURE;
+                    job->segs = grown;
+                    cap       = new_cap;
+                }
+                job->segs[job->nsegs].first  = mTemp;
+                job->segs[job->nsegs].nterms = 0;
+                job->nsegs++;
+            }
+            job->segs[job->nsegs - 1].nterms++;
+            n = (n + 1) % EXPORT_SEG_TERMS;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief  Writes every word of the index to path in the given format.
+ *
+ * @param  arr   The 27-bucket hash table.
+ * @param  docs  Aliases to expand (NULL = postings as stored).
+ * @param  fmt   EXPORT_TABLE, EXPORT_TSV or EXPORT_JSONL.
+ * @param  path  Output file, replaced if it exists.
+ * @return SUCCESS, or FAILURE on an I/O or allocation error.
+ */
+Status export_database(hash_T *arr, const docTable *docs, ExportFormat fmt, const char *path)
+{
+    exportJob job;
+    memset(&job, 0, sizeof(job));
+    job.docs = docs;
+    job.fmt  = fmt;
+
+    if(split_segments(arr, &job) == FAILURE)
+    {
+        free(job.segs);
+        return FAILURE;
+    }
+
+    FILE *fp = fopen(path, "w");
+    if(fp == NULL)
+    {
+        free(job.segs);
+        return FAILURE;
+    }
+
+    switch(fmt)
+    {
+        case EXPORT_TABLE:
+            fprintf(fp, TABLE_RULE);
+            fprintf(fp, "| %-10s | %-15s | %-10s | %-10s | %-40s |\n",
+                    "Index", "Word", "FileCount", "WordCount", "Filenames");
+            break;
+        case EXPORT_TSV:
+            fprintf(fp, "word\tfile\tcount\n");
+            break;
+        case EXPORT_JSONL:
+            break;
+    }
+
+    /* ── One formatting thread per CPU (none on a single CPU) ── */
+    long      ncpu     = sysconf(_SC_NPROCESSORS_ONLN);
+    u_int     want     = (ncpu > 1) ? (ncpu < EXPORT_MAX_THREADS ? ncpu : EXPORT_MAX_THREADS) : 0;
+    pthread_t threads[EXPORT_MAX_THREADS];
+    u_int     nthreads = 0;
+
+    job.window = want ? 2 * want : 1;
+    job.bufs   = calloc(job.window, sizeof(exportBuf));
+    Status ret = job.bufs ? SUCCESS : FAILURE;
+    for(u_int i = 0; job.bufs && i < job.window; i++)
+        job.bufs[i].seg = (u_int)-1;
+
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.formatted, NULL);
+    pthread_cond_init(&job.freed, NULL);
+    while(ret == SUCCESS && nthreads < want && job.nsegs > 1
+          && pthread_create(&threads[nthreads], NULL, export_worker, &job) == 0)
+        nthreads++;
+
+    /* ── Write segments in order as they are formatted ── */
+    for(u_int k = 0; ret == SUCCESS && k < job.nsegs; k++)
+    {
+        exportBuf *b = &job.bufs[k % job.window];
+
+        if(nthreads == 0)
+            format_segment(&job, k, b);     /* Format inline */
+        else
+        {
+            pthread_mutex_lock(&job.lock);
+            while(b->seg != k || !b->ready)
+                pthread_cond_wait(&job.formatted, &job.lock);
+            pthread_mutex_unlock(&job.lock);
+        }
+
+        if(b->failed || fwrite(b->data, 1, b->len, fp) != b->len)
+            ret = FAILURE;
+
+        pthread_mutex_lock(&job.lock);
+        job.written = k + 1;
+        pthread_cond_signal(&job.freed);
+        pthread_mutex_unlock(&job.lock);
+    }
+
+    /* ── Stop the workers (early on failure) ── */
+    pthread_mutex_lock(&job.lock);
+    job.stop = 1;
+    pthread_cond_broadcast(&job.freed);
+    pthread_mutex_unlock(&job.lock);
+    for(u_int i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.formatted);
+    pthread_cond_destroy(&job.freed);
+
+    if(fmt == EXPORT_TABLE)
+        fprintf(fp, TABLE_RULE);
+    if(ferror(fp))
+        ret = FAILURE;
+    if(fclose(fp) != 0)
+        ret = FAILURE;
+
+    for(u_int i = 0; job.bufs && i < job.window; i++)
+    {
+        free(job.bufs[i].data);
+        free(job.bufs[i].posts);
+    }
+    free(job.bufs);
+    free(job.segs);
+    return ret;
+}
@@ -0,0 +1,506 @@
+/**
+ * @file   external_database.c
+ * @brief  Memory-bounded (spill-to-disk) index build.
+ *
+ * create_database keeps the whole index in heap linked lists, so it either
+ * finishes or runs the machine out of memory. This module builds the same
+ * database.txt-style table without ever holding more than a fixed RAM
+ * budget:
+ *   1. Each file is tokenized into an lTable, whose distinct terms are
+ *      moved into an in-memory run of (term, file, count) records.
+ *   2. When run + lTable exceed the budget, the run is sorted by
+ *      (bucket, word, file) and spilled to an anonymous tmpfile().
+ *   3. Finally the runs are k-way merged through a min-heap. Whenever
+ *      EXT_MAX_FANIN runs pile up they are merged into one intermediate
+ *      run, so the number of open files stays bounded too.
+ *
+ * All run I/O is sequential. A file that does not fit the budget on its
+ * own is simply split across runs; the merge sums its partial counts.
+ *
+ * Rows come out in merge order: words alphabetically within a bucket, and
+ * files in Flist order. database.txt lists words in first-seen order, and
+ * lists a deduplicated copy next to its original. The two tables hold the
+ * same rows, but not in the same order.
+ */
+
+#include "main.h"
+
+#define EXT_MAX_FANIN 64        /* Runs merged at once (open file limit) */
+
+/* ─────────────────────────────────────────────
+ *  runRec — one (term, file, count) record
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    char  *word;    /* Owned string (moved from the lTable)   */
+    int    bucket;  /* bucket_index(word), primary sort key   */
+    u_int  file;    /* Position of the file in the Flist      */
+    u_int  count;   /* Occurrences of word in that file       */
+} runRec;
+
+/* ─────────────────────────────────────────────
+ *  runBuf — the in-memory run being filled
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    runRec *recs;
+    size_t  nrecs;
+    size_t  cap;
+    size_t  bytes;  /* Word bytes + record array, for the budget */
+} runBuf;
+
+/* ─────────────────────────────────────────────
+ *  runReader — cursor over one spilled run
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    FILE  *fp;
+    char   word[WORD_BUF_SIZE];
+    int    bucket;
+    u_int  file;
+    u_int  count;
+} runReader;
+
+/* ─────────────────────────────────────────────
+ *  extBuild — state of one external build
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    runBuf  run;
+    FILE  **runs;       /* Spilled, rewound run files */
+    int     nruns;
+    int     runs_cap;
+    u_int   spills;     /* Total runs written (for the summary) */
+    size_t  budget;     /* RAM budget in bytes                  */
+} extBuild;
+
+static int rec_cmp(int b1, const char *w1, u_int f1, int b2, const char *w2, u_int f2)
+{
+    if(b1 != b2)
+        return b1 - b2;
+    int c = strcmp(w1, w2);
+    if(c != 0)
+        return c;
+    return (f1 > f2) - (f1 < f2);
+}
+
+static int run_rec_cmp(const void *a, const void *b)
+{
+    const runRec *x = a, *y = b;
+    return rec_cmp(x->bucket, x->word, x->file, y->bucket, y->word, y->file);
+}
+
+static int reader_cmp(const runReader *x, const runReader *y)
+{
+    return rec_cmp(x->bucket, x->word, x->file, y->bucket, y->word, y->file);
+}
+
+/**
+ * @brief  Loads the next record of a run; returns 0 once the run is exhausted.
+ */
+static int reader_next(runReader *r)
+{
+    if(fscanf(r->fp, "%1023s %u %u", r->word, &r->file, &r->count) != 3)
+        return 0;
+    r->bucket = bucket_index(r->word);
+    return 1;
+}
+
+static Status reduce_runs(extBuild *b);
+
+static Status push_run(extBuild *b, FILE *fp)
+{
+    if(b->nruns == b->runs_cap)
+    {
+        int    new_cap = b->runs_cap ? b->runs_cap * 2 : 16;
+        FILE **grown   = realloc(b->runs, new_cap * sizeof(FILE *));
+        if(grown == NULL)
+            return FAILURE;
+        b->runs     = grown;
+        b->runs_cap = new_cap;
+    }
+    rewind(fp);
+    b->runs[b->nruns++] = fp;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Sorts the in-memory run and writes it to a new tmpfile().
+ */
+static Status spill_run(extBuild *b)
+{
+    runBuf *run = &b->run;
+    if(run->nrecs == 0)
+        return SUCCESS;
+
+    qsort(run->recs, run->nrecs, sizeof(runRec), run_rec_cmp);
+
+    FILE *fp = tmpfile();
+    if(fp == NULL)
+        return FAILURE;
+
+    for(size_t i = 0; i < run->nrecs; i++)
+    {
+        fprintf(fp, "%s\t%u\t%u\n", run->recs[i].word, run->recs[i].file, run->recs[i].count);
+        free(run->recs[i].word);
+    }
+    run->nrecs = 0;
+
+    /* An array grown past half the budget would force a spill per term */
+    if(run->cap * sizeof(runRec) > b->budget / 2)
+    {
+        free(run->recs);
+        run->recs = NULL;
+        run->cap  = 0;
+    }
+    run->bytes = run->cap * sizeof(runRec);
+
+    if(ferror(fp) || push_run(b, fp) == FAILURE)
+    {
+        fclose(fp);
+        return FAILURE;
+    }
+    (b->spills)++;
+    return reduce_runs(b);
+}
+
+/**
+ * @brief  Moves every term of the lTable into the in-memory run.
+ *
+ * A table that has grown past half the budget is reallocated at its
+ * initial size, so one term-heavy file cannot keep the build over budget.
+ */
+static Status drain_table(extBuild *b, lTable *t, u_int file)
+{
+    runBuf *run = &b->run;
+
+    for(u_int i = 0; i < t->nterms; i++)
+    {
+        if(run->nrecs == run->cap)
+        {
+            size_t  new_cap = run->cap ? run->cap * 2 : 1024;
+            runRec *grown   = realloc(run->recs, new_cap * sizeof(runRec));
+            if(grown == NULL)
+                return FAILURE;
+            run->bytes += (new_cap - run->cap) * sizeof(runRec);
+            run->recs   = grown;
+            run->cap    = new_cap;
+        }
+
+        runRec *rec = &run->recs[run->nrecs++];
+        rec->word   = t->terms[i].word;     /* Ownership moves to the run */
+        rec->bucket = bucket_index(rec->word);
+        rec->file   = file;
+        rec->count  = t->terms[i].count;
+        run->bytes += strlen(rec->word) + 1;
+        t->terms[i].word = NULL;
+    }
+    ltable_reset(t);
+
+    if(ltable_mem(t) > b->budget / 2)
+    {
+        ltable_free(t);
+        return ltable_init(t);
+    }
+    return SUCCESS;
+}
+
+/* ── Min-heap of run readers, ordered by reader_cmp ── */
+static void heap_sift_down(runReader **heap, int n, int i)
+{
+    while(1)
+    {
+        int l = 2 * i + 1, r = l + 1, min = i;
+        if(l < n && reader_cmp(heap[l], heap[min]) < 0) min = l;
+        if(r < n && reader_cmp(heap[r], heap[min]) < 0) min = r;
+        if(min == i)
+            return;
+        runReader *tmp = heap[i]; heap[i] = heap[min]; heap[min] = tmp;
+        i = min;
+    }
+}
+
+/**
+ * @brief  Appends "name" to a growable, ", "-separated filename list.
+ */
+static Status append_name(char **buf, size_t *len, size_t *cap, const char *name)
+{
+    size_t need = *len + strlen(name) + 3;
+    if(need > *cap)
+    {
+        size_t new_cap = *cap ? *cap : 256;
+        while(new_cap < need)
+            new_cap *= 2;
+        char *grown = realloc(*buf, new_cap);
+        if(grown == NULL)
+            return FAILURE;
+        *buf = grown;
+        *cap = new_cap;
+    }
+    *len += sprintf(*buf + *len, "%s%s", *len ? ", " : "", name);
+    return SUCCESS;
+}
+
+/**
+ * @brief  k-way merges runs[0 .. n-1] into out.
+ *
+ * With names == NULL the output is another run (equal (word, file) records
+ * are summed). Otherwise it is the final database table, one row per word,
+ * with file positions resolved through names[].
+ */
+static Status merge_runs(FILE **runs, int n, FILE *out, char **names)
+{
+    Status      ret    = SUCCESS;
+    runReader  *rd     = malloc(n * sizeof(runReader));
+    runReader **heap   = malloc(n * sizeof(runReader *));
+    char       *files  = NULL;
+    size_t      flen   = 0, fcap = 0;
+    if(n > 0 && (rd == NULL || heap == NULL))
+    {
+        free(rd);
+        free(heap);
+        return FAILURE;
+    }
+
+    int live = 0;
+    for(int i = 0; i < n; i++)
+    {
+        rd[i].fp = runs[i];
+        if(reader_next(&rd[i]))
+            heap[live++] = &rd[i];
+    }
+    for(int i = live / 2 - 1; i >= 0; i--)
+        heap_sift_down(heap, live, i);
+
+    /* ── Current group: one word (final) or one (word, file) (run) ── */
+    char  cur_word[WORD_BUF_SIZE] = "";
+    int   cur_bucket = -1;
+    u_int cur_file = 0, cur_count = 0;      /* Pending (word, file) record */
+    u_int filecount = 0, total = 0;         /* Totals for the final row    */
+    int   have = 0;
+
+    while(live > 0 || have)
+    {
+        runReader *top = live ? heap[0] : NULL;
+        int same_word  = top && have && top->bucket == cur_bucket && strcmp(top->word, cur_word) == 0;
+        int same_file  = same_word && top->file == cur_file;
+
+        if(top && same_file)
+        {
+            cur_count += top->count;
+        }
+        else
+        {
+            /* ── Close the pending (word, file) record ── */
+            if(have)
+            {
+                if(names == NULL)
+                    fprintf(out, "%s\t%u\t%u\n", cur_word, cur_file, cur_count);
+                else
+                {
+                    filecount++;
+                    total += cur_count;
+                    if(append_name(&files, &flen, &fcap, names[cur_file]) == FAILURE)
+                    {
+                        ret = FAILURE;
+                        break;
+                    }
+                }
+            }
+
+            /* ── Close the word's row when the word changes ── */
+            if(names != NULL && have && !same_word)
+            {
+                fprintf(out, "| %-10d | %-15s | %-10u | %-10u | %-40s |\n",
+                        cur_bucket, cur_word, filecount, total, files);
+                filecount = total = 0;
+                flen = 0;
+                files[0] = '\0';
+            }
+
+            if(top == NULL)
+                break;
+
+            strcpy(cur_word, top->word);
+            cur_bucket = top->bucket;
+            cur_file   = top->file;
+            cur_count  = top->count;
+            have       = 1;
+        }
+
+        /* ── Advance the run we just consumed ── */
+        if(reader_next(top))
+            heap_sift_down(heap, live, 0);
+        else
+        {
+            heap[0] = heap[--live];
+            heap_sift_down(heap, live, 0);
+        }
+    }
+
+    if(ferror(out))
+        ret = FAILURE;
+
+    free(files);
+    free(heap);
+    free(rd);
+    return ret;
+}
+
+/**
+ * @brief  Merges the oldest EXT_MAX_FANIN runs into one until fewer than
+ *         EXT_MAX_FANIN remain, keeping the number of open files bounded.
+ */
+static Status reduce_runs(extBuild *b)
+{
+    while(b->nruns >= EXT_MAX_FANIN)
+    {
+        FILE *fp = tmpfile();
+        if(fp == NULL)
+            return FAILURE;
+        if(merge_runs(b->runs, EXT_MAX_FANIN, fp, NULL) == FAILURE)
+        {
+            fclose(fp);
+            return FAILURE;
+        }
+
+        for(int i = 0; i < EXT_MAX_FANIN; i++)
+            fclose(b->runs[i]);
+        b->nruns -= EXT_MAX_FANIN;
+        memmove(b->runs, b->runs + EXT_MAX_FANIN, b->nruns * sizeof(FILE *));
+
+        if(push_run(b, fp) == FAILURE)
+        {
+            fclose(fp);
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+static void ext_free(extBuild *b, lTable *t, char **names)
+{
+    for(size_t i = 0; i < b->run.nrecs; i++)
+        free(b->run.recs[i].word);
+    free(b->run.recs);
+    for(int i = 0; i < b->nruns; i++)
+        fclose(b->runs[i]);
+    free(b->runs);
+    free(names);
+    ltable_free(t);
+}
+
+/**
+ * @brief  Indexes every file in the Flist within a RAM budget and writes the
+ *         resulting table to out_path.
+ *
+ * @param  head      Head of the Flist (files to index).
+ * @param  budget    RAM budget in bytes for the run + per-file table
+ *                   (clamped to EXT_MIN_BUDGET).
+ * @param  mode      How documents are read (see ingest_utils.c).
+ * @param  depth     Documents in flight (0 = INGEST_DEPTH).
+ * @param  out_path  Destination of the merged, database.txt-style table.
+ * @param  runs      If not NULL, receives the number of runs spilled.
+ * @return SUCCESS, or FAILURE on an I/O or allocation error.
+ */
+Status create_database_external(Flist *head, size_t budget, IngestMode mode, u_int depth,
+                                const char *out_path, u_int *runs)
+{
+    extBuild b = {0};
+    lTable   local;
+    u_int    nfiles = 0;
+
+    if(budget < EXT_MIN_BUDGET)
+        budget = EXT_MIN_BUDGET;
+    b.budget = budget;
+
+    for(Flist *temp = head; temp; temp = temp->link)
+        nfiles++;
+
+    /* Flist positions stand in for filenames inside the runs */
+    char **names = malloc((nfiles ? nfiles : 1) * sizeof(char *));
+    if(names == NULL)
+        return FAILURE;
+    nfiles = 0;
+    for(Flist *temp = head; temp; temp = temp->link)
+        names[nfiles++] = temp->file_name;
+
+    if(ltable_init(&local) == FAILURE)
+    {
+        free(names);
+        return FAILURE;
+    }
+
+    ingestReader *reader = ingest_open(head, mode, depth, 0);
+    if(reader == NULL)
+    {
+        ext_free(&b, &local, names);
+        return FAILURE;
+    }
+
+    /* ── Phase 1: tokenize, spilling sorted runs when over budget ──
+     * Documents arrive in Flist order, so the f-th one is names[f]. */
+    Flist *temp;
+    FILE  *fp;
+    for(u_int f = 0; (fp = ingest_next(reader, &temp)) != NULL; f++)
+    {
+        char input_word[WORD_BUF_SIZE];
+        int  ok = 1;
+        while(ok && next_token(fp, input_word))
+        {
+            if(ltable_add(&local, input_word) == FAILURE)
+                ok = 0;
+            else if(b.run.bytes + ltable_mem(&local) > budget)
+                ok = drain_table(&b, &local, f) == SUCCESS && spill_run(&b) == SUCCESS;
+        }
+        if(ferror(fp))
+            ok = 0;
+        if(fclose(fp) != 0)
+            ok = 0;
+
+        if(!ok || drain_table(&b, &local, f) == FAILURE
+               || (b.run.bytes + ltable_mem(&local) > budget && spill_run(&b) == FAILURE))
+        {
+            ingest_close(reader);
+            ext_free(&b, &local, names);
+            return FAILURE;
+        }
+    }
+
+    /* A document that could not be opened or read ends the loop early */
+    if(ingest_close(reader) == FAILURE)
+    {
+        ext_free(&b, &local, names);
+        return FAILURE;
+    }
+
+    /* ── Phase 2: spill the tail run and merge everything ── */
+    if(spill_run(&b) == FAILURE)
+    {
+        ext_free(&b, &local, names);
+        return FAILURE;
+    }
+
+    FILE *out = fopen(out_path, "w");
+    if(out == NULL)
+    {
+        ext_free(&b, &local, names);
+        return FAILURE;
+    }
+
+    fprintf(out, "____________________________________________________________________________________________________\n");
+    fprintf(out, "| %-10s | %-15s | %-10s | %-10s | %-40s |\n",
+            "Index", "Word", "FileCount", "WordCount", "Filenames");
+
+    Status ret = merge_runs(b.runs, b.nruns, out, names);
+
+    fprintf(out, "____________________________________________________________________________________________________\n");
+    if(fclose(out) != 0)
+        ret = FAILURE;
+
+    if(runs)
+        *runs = b.spills;
+
+    ext_free(&b, &local, names);
+    return ret;
+}
@@ -24,4 +24,76 @@ void strip_punctuation(char *word)
         // Everything else is silently dropped
     }
     word[write] = '\0';
-}
\ No newline at end of file
+}
+
+/**
+ * @brief  Reads the next non-empty, punctuation-stripped token from fp.
+ *
+ * Tokens that are pure punctuation (e.g. "---" → "") are skipped.
+ *
+ * @param  fp    Open text file.
+ * @param  word  Output buffer of at least WORD_BUF_SIZE bytes.
+ * @return 1 if a token was stored in word, 0 at end of file.
+ */
+int next_token(FILE *fp, char *word)
+{
+    while(fscanf(fp, "%1023s", word) != EOF)
+    {
+        strip_punctuation(word);
+        if(word[0] != '\0')
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief  64-bit FNV-1a hash of a NUL-terminated string.
+ *
+ * Cheap, byte-at-a-time and good enough to spread index terms across
+ * power-of-two tables. Not cryptographic.
+ */
+uint64_t hash_word(const char *word)
+{
+    uint64_t h = 14695981039346656037ULL;   /* FNV offset basis */
+
+    while(*word)
+    {
+        h ^= (unsigned char)*word++;
+        h *= 1099511628211ULL;              /* FNV prime */
+    }
+    return h;
+}
+
+/**
+ * @brief  64-bit hash of a byte buffer, eight bytes per step.
+ *
+ * Used to recognise byte-identical documents (dedup_utils.c). A long
+ * input hashed in chunks chains through seed: hash_bytes(b, n, h) with h
+ * the previous chunk's result. Chunk boundaries therefore change the
+ * value, so callers always hash in the same chunk size. Not cryptographic.
+ */
+uint64_t hash_bytes(const void *data, size_t len, uint64_t seed)
+{
+    const unsigned char *p = data;
+    uint64_t             h = seed ^ (len * 0x9E3779B97F4A7C15ULL);
+    uint64_t             k;
+
+    for(; len >= 8; p += 8, len -= 8)
+    {
+        memcpy(&k, p, 8);
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 32;
+        h  = (h ^ k) * 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 29;
+    }
+
+    k = 0;
+    memcpy(&k, p, len);                     /* 0–7 tail bytes */
+    h  = (h ^ k) * 0xc4ceb9fe1a85ec53ULL;
+
+    /* Final avalanche */
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
@@ -6,8 +6,11 @@
  * loop walked it again to find the tail — two full O(F) traversals.
  * Now both happen in one loop: duplicate check at every node, tail found
  * naturally when temp->link == NULL.
+ *
+ * Returns SUCCESS, DUPLICATE if fname is already listed, or FAILURE if
+ * allocation fails.
  */
-Status insert_at_last(Flist **head, char *fname)
+Status insert_at_last(Flist **head, const char *fname)
 {
     Flist *new = malloc(sizeof(Flist));
     if(new == NULL)
@@ -33,7 +36,7 @@ Status insert_at_last(Flist **head, char *fname)
         {
             free(new->file_name);   /* free heap string before dropping the node */
             free(new);
-            return FAILURE;         /* Duplicate found mid-list */
+            return DUPLICATE;       /* Duplicate found mid-list */
         }
         temp = temp->link;
     }
@@ -43,41 +46,15 @@ Status insert_at_last(Flist **head, char *fname)
     {
         free(new->file_name);
         free(new);
-        return FAILURE;             /* Duplicate is the tail node */
+        return DUPLICATE;           /* Duplicate is the tail node */
     }
 
     temp->link = new;
     return SUCCESS;
 }
 
-void print_list(Flist *head)
-{
-    if(head == NULL)
-    {
-        printf(H_YELLOW "[Info] : List is Empty\n" RESET);
-        return;
-    }
-
-    printf(BG_BLUE "_____________________________\n" RESET);
-    printf("\n");
-    while(head)
-    {
-        printf(BOLD_YELLOW "| %s |" RESET, head->file_name);
-        printf(H_CYAN "%s" RESET, head->link ? " -> " : "\n");
-        head = head->link;
-    }
-    printf(BG_BLUE "_____________________________\n" RESET);
-    printf("\n");
-}
-
 void free_list(Flist **head)
 {
-    if(*head == NULL)
-    {
-        printf(H_YELLOW "[Info] : List is Empty\n" RESET);
-        return;
-    }
-
     while(*head)
     {
         Flist *temp = *head;
@@ -0,0 +1,416 @@
+/**
+ * @file   fuzzy_database.c
+ * @brief  Typo-tolerant lookup with bounded edit distance.
+ *
+ * Computing an edit distance against every dictionary word is too slow on
+ * a large vocabulary, so this module uses a deletion-neighbourhood index
+ * (the SymSpell scheme):
+ *   - For every word, all strings reachable by deleting up to
+ *     FUZZY_MAX_DIST characters from its first FUZZY_PREFIX characters
+ *     are hashed and mapped to the word's id.
+ *   - A query generates the same deletions of itself. Any two words
+ *     within distance d share at least one such deletion, so the
+ *     union of the matching posting lists is a small candidate set.
+ *   - Candidates are verified with a bounded optimal-string-alignment
+ *     (Damerau-Levenshtein) distance and ranked by distance, then by
+ *     the number of files the word appears in (mNode->filecount).
+ *
+ * Restricting deletions to a prefix keeps the index at
+ * 1 + P + P(P-1)/2 entries per word regardless of word length; verifying
+ * on the full word keeps the results exact.
+ *
+ * Like the trigram index, this is a snapshot rebuilt lazily once stale.
+ */
+
+#include "main.h"
+
+#define FUZZY_PREFIX       7    /* Characters of each word that are deleted from */
+#define FUZZY_INIT_SLOTS   4096
+
+/* ─────────────────────────────────────────────
+ *  fzHit — one verified suggestion
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    mNode *node;
+    u_int  dist;
+} fzHit;
+
+static u_int fz_slot(uint64_t key, u_int mask)
+{
+    return (u_int)(key ^ (key >> 32)) & mask;
+}
+
+/**
+ * @brief  Hash of a deletion variant; 0 is reserved for empty slots.
+ */
+static uint64_t fz_key(const char *variant)
+{
+    uint64_t h = hash_word(variant);
+    return h ? h : 1;
+}
+
+static Status fz_grow(fzIndex *fi)
+{
+    u_int    new_slots = fi->nslots * 2;
+    u_int    mask      = new_slots - 1;
+    fzPost  *grown     = calloc(new_slots, sizeof(fzPost));
+    if(grown == NULL)
+        return FAILURE;
+
+    for(u_int i = 0; i < fi->nslots; i++)
+    {
+        if(fi->posts[i].key == 0)
+            continue;
+        u_int pos = fz_slot(fi->posts[i].key, mask);
+        while(grown[pos].key)
+            pos = (pos + 1) & mask;
+        grown[pos] = fi->posts[i];
+    }
+
+    free(fi->posts);
+    fi->posts  = grown;
+    fi->nslots = new_slots;
+    return SUCCESS;
+}
+
+static fzPost *fz_find(fzIndex *fi, uint64_t key)
+{
+    u_int mask = fi->nslots - 1;
+    for(u_int pos = fz_slot(key, mask); fi->posts[pos].key; pos = (pos + 1) & mask)
+        if(fi->posts[pos].key == key)
+            return &fi->posts[pos];
+    return NULL;
+}
+
+/**
+ * @brief  Records that word id has the deletion variant (once per word).
+ */
+static Status fz_add(fzIndex *fi, const char *variant, u_int id)
+{
+    if(2 * (fi->nposts + 1) > fi->nslots && fz_grow(fi) == FAILURE)
+        return FAILURE;
+
+    uint64_t key  = fz_key(variant);
+    u_int    mask = fi->nslots - 1;
+    u_int    pos  = fz_slot(key, mask);
+    while(fi->posts[pos].key && fi->posts[pos].key != key)
+        pos = (pos + 1) & mask;
+
+    fzPost *post = &fi->posts[pos];
+    if(post->key == 0)
+    {
+        post->key = key;
+        (fi->nposts)++;
+    }
+
+    /* All variants of one word are added together — a repeat is the last id */
+    if(post->nids && post->ids[post->nids - 1] == id)
+        return SUCCESS;
+
+    if(post->nids == post->cap)
+    {
+        u_int  new_cap = post->cap ? post->cap * 2 : 2;
+        u_int *ids     = realloc(post->ids, new_cap * sizeof(u_int));
+        if(ids == NULL)
+            return FAILURE;
+        post->ids = ids;
+        post->cap = new_cap;
+    }
+    post->ids[post->nids++] = id;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Lower-cases the first FUZZY_PREFIX characters of word into key.
+ * @return Length of key.
+ */
+static size_t fz_prefix(const char *word, char *key)
+{
+    size_t len = 0;
+    while(word[len] && len < FUZZY_PREFIX)
+    {
+        key[len] = tolower((unsigned char)word[len]);
+        len++;
+    }
+    key[len] = '\0';
+    return len;
+}
+
+/**
+ * @brief  Calls fn on key and on every string made by deleting up to
+ *         max_dist of its characters (positions i < j for two deletions).
+ */
+static Status fz_variants(const char *key, size_t len, u_int max_dist,
+                          Status (*fn)(const char *variant, void *ctx), void *ctx)
+{
+    char buf[FUZZY_PREFIX + 1];
+
+    if(fn(key, ctx) == FAILURE)
+        return FAILURE;
+
+    for(size_t i = 0; max_dist >= 1 && i < len; i++)
+    {
+        /* ── One deletion at i ── */
+        size_t n = 0;
+        for(size_t k = 0; k < len; k++)
+            if(k != i) buf[n++] = key[k];
+        buf[n] = '\0';
+        if(fn(buf, ctx) == FAILURE)
+            return FAILURE;
+
+        /* ── Two deletions at i < j ── */
+        for(size_t j = i + 1; max_dist >= 2 && j < len; j++)
+        {
+            n = 0;
+            for(size_t k = 0; k < len; k++)
+                if(k != i && k != j) buf[n++] = key[k];
+            buf[n] = '\0';
+            if(fn(buf, ctx) == FAILURE)
+                return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+/* ── Callback context while building ── */
+typedef struct
+{
+    fzIndex *fi;
+    u_int    id;
+} fzBuildCtx;
+
+static Status build_cb(const char *variant, void *arg)
+{
+    fzBuildCtx *ctx = arg;
+    return fz_add(ctx->fi, variant, ctx->id);
+}
+
+/**
+ * @brief  Snapshots the dictionary and indexes its deletion neighbourhoods.
+ *
+ * @param  fi   Fuzzy index (any previous contents are freed).
+ * @param  arr  The 27-bucket hash table.
+ * @return SUCCESS, or FAILURE on malloc failure.
+ */
+Status build_fuzzy_index(fzIndex *fi, hash_T *arr)
+{
+    free_fuzzy_index(fi);
+
+    u_int nwords = 0;
+    for(int i = 0; i < 27; i++)
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
+            nwords++;
+
+    fi->words  = malloc((nwords ? nwords : 1) * sizeof(mNode *));
+    fi->posts  = calloc(FUZZY_INIT_SLOTS, sizeof(fzPost));
+    fi->nslots = FUZZY_INIT_SLOTS;
+    if(fi->words == NULL || fi->posts == NULL)
+    {
+        free_fuzzy_index(fi);
+        return FAILURE;
+    }
+
+    char       key[FUZZY_PREFIX + 1];
+    fzBuildCtx ctx = { fi, 0 };
+    for(int i = 0; i < 27; i++)
+    {
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
+        {
+            ctx.id = fi->nwords++;
+            fi->words[ctx.id] = mTemp;
+
+            size_t len = fz_prefix(mTemp->word, key);
+            if(fz_variants(key, len, FUZZY_MAX_DIST, build_cb, &ctx) == FAILURE)
+            {
+                free_fuzzy_index(fi);
+                return FAILURE;
+            }
+        }
+    }
+
+    fi->stale = 0;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Optimal-string-alignment distance between a (lower-case) and b,
+ *         case-insensitive, giving up once it must exceed max_dist.
+ *
+ * @return The distance, or max_dist + 1 if it is larger than max_dist.
+ */
+static u_int bounded_distance(const char *a, const char *b, u_int max_dist)
+{
+    size_t la = strlen(a), lb = strlen(b);
+    if((la > lb ? la - lb : lb - la) > max_dist)
+        return max_dist + 1;
+
+    /* Three rolling rows: i-2 (for transpositions), i-1 and i */
+    u_int *rows = malloc(3 * (lb + 1) * sizeof(u_int));
+    if(rows == NULL)
+        return max_dist + 1;
+    u_int *prev2 = rows, *prev = rows + lb + 1, *cur = rows + 2 * (lb + 1);
+
+    for(size_t j = 0; j <= lb; j++)
+        prev[j] = j;
+
+    for(size_t i = 1; i <= la; i++)
+    {
+        u_int row_min = cur[0] = i;
+        for(size_t j = 1; j <= lb; j++)
+        {
+            char  bj   = tolower((unsigned char)b[j - 1]);
+            u_int cost = (a[i - 1] != bj);
+            u_int best = prev[j - 1] + cost;                   /* substitute */
+            if(prev[j] + 1 < best)    best = prev[j] + 1;      /* delete     */
+            if(cur[j - 1] + 1 < best) best = cur[j - 1] + 1;   /* insert     */
+            if(i > 1 && j > 1 && a[i - 1] == tolower((unsigned char)b[j - 2])
+                              && a[i - 2] == bj
+                              && prev2[j - 2] + 1 < best)
+                best = prev2[j - 2] + 1;                       /* transpose  */
+            cur[j] = best;
+            if(best < row_min)
+                row_min = best;
+        }
+
+        if(row_min > max_dist)          /* Every path is already too long */
+        {
+            free(rows);
+            return max_dist + 1;
+        }
+
+        u_int *tmp = prev2; prev2 = prev; prev = cur; cur = tmp;
+    }
+
+    u_int dist = prev[lb];
+    free(rows);
+    return dist;
+}
+
+/* ── Callback context while querying ── */
+typedef struct
+{
+    fzIndex       *fi;
+    unsigned char *seen;    /* One flag per word id      */
+    u_int         *cand;    /* Distinct candidate ids    */
+    u_int          ncand;
+} fzQueryCtx;
+
+static Status query_cb(const char *variant, void *arg)
+{
+    fzQueryCtx *ctx  = arg;
+    fzPost     *post = fz_find(ctx->fi, fz_key(variant));
+    if(post == NULL)
+        return SUCCESS;
+
+    for(u_int i = 0; i < post->nids; i++)
+    {
+        u_int id = post->ids[i];
+        if(!ctx->seen[id])
+        {
+            ctx->seen[id] = 1;
+            ctx->cand[ctx->ncand++] = id;
+        }
+    }
+    return SUCCESS;
+}
+
+static int hit_cmp(const void *a, const void *b)
+{
+    const fzHit *x = a, *y = b;
+    if(x->dist != y->dist)
+        return (x->dist > y->dist) - (x->dist < y->dist);
+    if(x->node->filecount != y->node->filecount)
+        return (x->node->filecount < y->node->filecount) - (x->node->filecount > y->node->filecount);
+    return strcmp(x->node->word, y->node->word);
+}
+
+/**
+ * @brief  Reports dictionary words within max_dist edits of word, best first.
+ *
+ * @param  fi        Fuzzy index (rebuilt first if stale).
+ * @param  arr       The 27-bucket hash table it indexes.
+ * @param  word      The (possibly misspelled) query.
+ * @param  max_dist  Largest edit distance accepted, 1 .. FUZZY_MAX_DIST.
+ * @param  fn        Receives each suggestion in rank order with its
+ *                   distance; non-zero stops the search.
+ * @param  ctx       Passed through to fn.
+ * @return SUCCESS if anything was close enough, DATA_NOT_FOUND otherwise,
+ *         FAILURE on malloc failure or an out-of-range max_dist.
+ */
+Status search_fuzzy(fzIndex *fi, hash_T *arr, const char *word, u_int max_dist,
+                    match_fn fn, void *ctx)
+{
+    if(max_dist == 0 || max_dist > FUZZY_MAX_DIST)
+        return FAILURE;
+    if((fi->stale || fi->posts == NULL) && build_fuzzy_index(fi, arr) == FAILURE)
+        return FAILURE;
+
+    fzQueryCtx query = { fi, calloc(fi->nwords + 1, 1), malloc((fi->nwords + 1) * sizeof(u_int)), 0 };
+    if(query.seen == NULL || query.cand == NULL)
+    {
+        free(query.seen);
+        free(query.cand);
+        return FAILURE;
+    }
+
+    /* ── Candidates: words sharing a deletion variant with the query ── */
+    char   key[FUZZY_PREFIX + 1];
+    size_t len = fz_prefix(word, key);
+    fz_variants(key, len, max_dist, query_cb, &query);
+
+    /* ── Verify on the full words ── */
+    char lower[WORD_BUF_SIZE];
+    size_t n = 0;
+    for(; word[n] && n < WORD_BUF_SIZE - 1; n++)
+        lower[n] = tolower((unsigned char)word[n]);
+    lower[n] = '\0';
+
+    fzHit *hits  = malloc((query.ncand + 1) * sizeof(fzHit));
+    u_int  nhits = 0;
+    if(hits == NULL)
+    {
+        free(query.seen);
+        free(query.cand);
+        return FAILURE;
+    }
+    for(u_int i = 0; i < query.ncand; i++)
+    {
+        mNode *node = fi->words[query.cand[i]];
+        u_int  dist = bounded_distance(lower, node->word, max_dist);
+        if(dist <= max_dist)
+        {
+            hits[nhits].node = node;
+            hits[nhits].dist = dist;
+            nhits++;
+        }
+    }
+
+    /* ── Rank: distance, then document frequency ── */
+    if(nhits > 1)
+        qsort(hits, nhits, sizeof(fzHit), hit_cmp);
+    for(u_int i = 0; i < nhits; i++)
+        if(fn(&hits[i].node, 1, hits[i].dist, ctx))
+            break;
+
+    free(hits);
+    free(query.seen);
+    free(query.cand);
+    return nhits ? SUCCESS : DATA_NOT_FOUND;
+}
+
+/**
+ * @brief  Frees the fuzzy index and marks it for rebuild.
+ */
+void free_fuzzy_index(fzIndex *fi)
+{
+    if(fi->posts)
+        for(u_int i = 0; i < fi->nslots; i++)
+            free(fi->posts[i].ids);
+    free(fi->posts);
+    free(fi->words);
+    fi->posts  = NULL;
+    fi->words  = NULL;
+    fi->nwords = fi->nslots = fi->nposts = 0;
+    fi->stale  = 1;
+}
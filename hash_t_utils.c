@@ -1,17 +1,41 @@
 /**
  * @file   hash_t_utils.c
- * @brief  Initialization and teardown for the 27-bucket hash table.
+ * @brief  Initialization, word storage and teardown for the 27-bucket
+ *         hash table.
  *
- * The hash table is a stack-allocated array of hash_T structs in main().
- * This module provides the two lifecycle operations: setup and full free.
+ * The hash table is an array of hash_T structs embedded in each InvIndex.
+ * Each bucket owns its words outright:
+ *   - mNodes are carved, in chain order, from cache-line-aligned slabs,
+ *     so a chain walk reads memory front to back instead of hopping
+ *     between unrelated malloc blocks;
+ *   - a word shorter than MNODE_INLINE is stored inside its mNode, and a
+ *     longer one in the bucket's byte slabs;
+ *   - an open-addressing directory of (hash, mNode) slots finds a word
+ *     without walking the chain, and rejects almost every mismatch on
+ *     the stored hash alone.
+ * Nothing is freed word by word; free_hash_table releases whole slabs.
  */
 
 #include "main.h"
 
+#define DICT_INIT_SLOTS   16            /* Directory slots of a new bucket   */
+#define SLAB_MIN_NODES    16            /* mNodes in a bucket's first slab   */
+#define SLAB_MAX_NODES    4096          /* mNodes per slab once grown        */
+#define SLAB_MIN_BYTES    1024          /* Long-word bytes in the first slab */
+#define SLAB_MAX_BYTES    (64 * 1024)   /* Long-word bytes per slab          */
+#define CACHE_LINE        64
+
+/* Spreads the hash over the slot bits: shards keep only words with equal
+ * hash % nshards, so the low bits alone would cluster */
+static u_int slot_of(uint64_t hash, u_int mask)
+{
+    return (u_int)((hash * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
 /**
  * @brief  Initializes all 27 hash table buckets to a clean state.
  *
- * Sets each bucket's index and sets the mNode link to NULL.
+ * Sets each bucket's index and leaves it without words or storage.
  * Must be called before create_database or any search operations.
  *
  * @param  arr  The hash table array (length 27).
@@ -20,19 +44,161 @@ void initialize_hashTable(hash_T *arr)
 {
     for(int i = 0; i < 27; i++)
     {
+        memset(&arr[i], 0, sizeof(hash_T));
         arr[i].index = i;
-        arr[i].link  = NULL;
     }
+}
+
+/**
+ * @brief  Finds a word in one bucket through its directory.
+ *
+ * @param  hash  hash_word(word).
+ * @param  len   strlen(word).
+ * @return The word's mNode, or NULL if the bucket does not hold it.
+ */
+mNode *bucket_find(const hash_T *bucket, const char *word, uint64_t hash, u_int len)
+{
+    if(bucket->nslots == 0)
+        return NULL;
+
+    u_int mask = bucket->nslots - 1;
+    for(u_int pos = slot_of(hash, mask); bucket->slots[pos].node; pos = (pos + 1) & mask)
+    {
+        mNode *node = bucket->slots[pos].node;
+        if(bucket->slots[pos].hash == hash && node->len == len && memcmp(node->word, word, len) == 0)
+            return node;
+    }
+    return NULL;
+}
+
+/**
+ * @brief  Doubles a bucket's directory, re-inserting from stored hashes.
+ */
+static Status grow_slots(hash_T *bucket)
+{
+    u_int     nslots = bucket->nslots ? bucket->nslots * 2 : DICT_INIT_SLOTS;
+    u_int     mask   = nslots - 1;
+    dictSlot *slots  = calloc(nslots, sizeof(dictSlot));
+    if(slots == NULL)
+        return FAILURE;
+
+    for(u_int i = 0; i < bucket->nslots; i++)
+    {
+        if(bucket->slots[i].node == NULL)
+            continue;
+        u_int pos = slot_of(bucket->slots[i].hash, mask);
+        while(slots[pos].node)
+            pos = (pos + 1) & mask;
+        slots[pos] = bucket->slots[i];
+    }
+
+    free(bucket->slots);
+    bucket->slots  = slots;
+    bucket->nslots = nslots;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Hands out size bytes from the newest slab of a list, starting a
+ *         new slab (double the last, up to max_cap) when it is full.
+ */
+static void *slab_alloc(dictSlab **list, size_t size, size_t min_cap, size_t max_cap, int aligned)
+{
+    dictSlab *slab = *list;
+
+    if(slab == NULL || slab->cap - slab->used < size)
+    {
+        size_t cap = slab ? slab->cap * 2 : min_cap;
+        if(cap > max_cap)
+            cap = max_cap;
+        if(cap < size)
+            cap = size;
+
+        dictSlab *fresh = malloc(sizeof(dictSlab));
+        if(fresh == NULL)
+            return NULL;
+        fresh->data = aligned ? aligned_alloc(CACHE_LINE, cap) : malloc(cap);
+        if(fresh->data == NULL)
+        {
+            free(fresh);
+            return NULL;
+        }
+        fresh->used = 0;
+        fresh->cap  = cap;
+        fresh->next = slab;
+        *list = slab = fresh;
+    }
+
+    void *p = slab->data + slab->used;
+    slab->used += size;
+    return p;
+}
+
+/**
+ * @brief  Adds a word the bucket does not hold yet at the end of its chain.
+ *
+ * The word is copied; the new mNode has no sNodes and filecount 0.
+ *
+ * @return The new mNode, or NULL on malloc failure (the bucket is unchanged).
+ */
+mNode *bucket_append(hash_T *bucket, const char *word, uint64_t hash, u_int len)
+{
+    /* ── Keep the directory at most half full ── */
+    if(2 * (bucket->nwords + 1) > bucket->nslots && grow_slots(bucket) == FAILURE)
+        return NULL;
+
+    char *text = NULL;
+    if(len >= MNODE_INLINE)
+    {
+        text = slab_alloc(&bucket->bytes, len + 1, SLAB_MIN_BYTES, SLAB_MAX_BYTES, 0);
+        if(text == NULL)
+            return NULL;
+    }
+    mNode *node = slab_alloc(&bucket->nodes, sizeof(mNode), SLAB_MIN_NODES * sizeof(mNode),
+                             SLAB_MAX_NODES * sizeof(mNode), 1);
+    if(node == NULL)
+        return NULL;
+
+    node->word = text ? text : node->inl;
+    memcpy(node->word, word, len + 1);
+    node->len       = len;
+    node->filecount = 0;
+    node->sLink     = node->sTail = NULL;
+    node->mLink     = NULL;
 
-    printf(H_MAGENTA "Hash Table initialised Successfully\n" RESET);
+    u_int mask = bucket->nslots - 1;
+    u_int pos  = slot_of(hash, mask);
+    while(bucket->slots[pos].node)
+        pos = (pos + 1) & mask;
+    bucket->slots[pos].hash = hash;
+    bucket->slots[pos].node = node;
+
+    if(bucket->tail)
+        bucket->tail->mLink = node;
+    else
+        bucket->link = node;            /* Bucket was empty */
+    bucket->tail = node;
+    (bucket->nwords)++;
+    return node;
+}
+
+static void free_slabs(dictSlab *slab)
+{
+    while(slab)
+    {
+        dictSlab *next = slab->next;
+        free(slab->data);
+        free(slab);
+        slab = next;
+    }
 }
 
 /**
- * @brief  Frees all heap-allocated mNode and sNode chains in the hash table.
+ * @brief  Frees all sNode chains and word storage in the hash table.
  *
- * For each mNode: frees its sNode chain (including each sNode's file_name),
- * then frees the mNode's word string, then frees the mNode itself.
- * Does NOT free the hash_T array (it's stack-allocated in main).
+ * For each mNode, frees its sNode chain (including each sNode's
+ * file_name); the mNodes and words go with their bucket's slabs.
+ * Does NOT free the hash_T array itself (it's part of the InvIndex).
  *
  * @param  arr  The hash table array (length 27).
  */
@@ -40,10 +206,8 @@ void free_hash_table(hash_T *arr)
 {
     for(int i = 0; i < 27; i++)
     {
-        mNode *mTemp = arr[i].link;
-        while(mTemp)
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
         {
-            /* ── Free all sNodes for this word first ── */
             sNode *sTemp = mTemp->sLink;
             while(sTemp)
             {
@@ -52,12 +216,29 @@ void free_hash_table(hash_T *arr)
                 free(sPrev->file_name); /* free heap-allocated filename */
                 free(sPrev);
             }
-
-            /* ── Advance before freeing — then free word and node ── */
-            mNode *mPrev = mTemp;
-            mTemp = mTemp->mLink;
-            free(mPrev->word);          /* free heap-allocated word string */
-            free(mPrev);
         }
+
+        free_slabs(arr[i].nodes);
+        free_slabs(arr[i].bytes);
+        free(arr[i].slots);
+        arr[i].nodes  = arr[i].bytes = NULL;
+        arr[i].slots  = NULL;
+        arr[i].link   = arr[i].tail = NULL;
+        arr[i].nslots = arr[i].nwords = 0;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief  Maps a word to its bucket from the first character.
+ *
+ * @param  word  Non-empty word.
+ * @return 0–25 for a–z / A–Z, 26 for anything else.
+ */
+int bucket_index(const char *word)
+{
+    if(islower(word[0]))
+        return word[0] - 'a';        /* a=0, b=1, ..., z=25 */
+    if(isupper(word[0]))
+        return word[0] - 'A';        /* A=0, B=1, ..., Z=25 */
+    return 26;                       /* Non-alphabetic token */
+}
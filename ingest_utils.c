@@ -0,0 +1,928 @@
+/**
+ * @file   ingest_utils.c
+ * @brief  Batched document reads for corpora of many small files.
+ *
+ * Indexing one small file at a time spends most of its time waiting on
+ * open/read/close rather than tokenizing. An ingestReader keeps up to
+ * `depth` documents in flight and hands them to the tokenizer, in Flist
+ * order, as FILE streams:
+ *
+ *   INGEST_URING    Each document is one linked open → read → close chain
+ *                   on an io_uring, using direct (ring-registered) file
+ *                   descriptors. A whole window is queued with one
+ *                   io_uring_enter; no liburing, raw syscalls only.
+ *   INGEST_THREADS  A small pool of reader threads does the same with
+ *                   blocking open/read/close. Used when io_uring is not
+ *                   available (old kernel, seccomp, ...).
+ *   INGEST_SERIAL   The plain loop: open the next document while the
+ *                   current one is tokenized.
+ *
+ * Documents up to INGEST_DOC_MAX bytes are read whole into a slot buffer
+ * and exposed through fmemopen. Larger or compressed documents are
+ * streamed with open_document instead, one of them opened ahead.
+ *
+ * Documents are delivered in order even though reads complete out of
+ * order, so the index is identical whichever backend built it.
+ *
+ * On request each document also comes with its content hash (hash_bytes
+ * over its text, in INGEST_DOC_MAX chunks). A batched document is hashed
+ * from its buffer. A streamed one is hashed as the caller reads it,
+ * through a stream layered over open_document, so no document is read
+ * twice; its hash is known once it has been read to the end.
+ */
+
+#define _GNU_SOURCE         /* fmemopen, O_CLOEXEC */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+#include "main.h"
+
+#define INGEST_DOC_MAX     (64 * 1024)  /* Larger documents are streamed */
+#define INGEST_POOL_MAX    8            /* Threads in the fallback pool  */
+
+/* user_data of a uring completion: (file index << 2) | op */
+#define URING_OP_OPEN   0
+#define URING_OP_READ   1
+#define URING_OP_CLOSE  2
+
+typedef enum
+{
+    SLOT_PENDING,   /* Read in flight (or not started)      */
+    SLOT_READY,     /* buf holds the whole document         */
+    SLOT_STREAM,    /* Too large or compressed — stream it  */
+    SLOT_FAILED     /* Open or read error                   */
+} SlotState;
+
+/* ─────────────────────────────────────────────
+ *  ingestSlot — One document of the window
+ *  File j always uses slot j % depth.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    u_int      file;        /* Index of the file held             */
+    SlotState  state;
+    char      *buf;         /* INGEST_DOC_MAX bytes               */
+    size_t     len;
+    u_int      pending;     /* Uring completions still expected   */
+    int        open_res;
+    int        read_res;
+} ingestSlot;
+
+/* ─────────────────────────────────────────────
+ *  uRing — Minimal io_uring (SQ / CQ ring views)
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    int                   fd;
+    u_int                 entries;
+    u_int                *sq_head, *sq_tail, *sq_mask, *sq_array;
+    u_int                *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe  *sqes;
+    struct io_uring_cqe  *cqes;
+    void                 *sq_ptr, *cq_ptr;
+    size_t                sq_size, cq_size, sqes_size;
+    u_int                 queued;   /* SQEs written, not yet submitted */
+    u_int                 inflight; /* Submitted, not yet reaped       */
+} uRing;
+
+struct ingestReader
+{
+    IngestMode   mode;      /* Backend in use (never INGEST_AUTO)     */
+    Flist      **files;     /* The Flist as an array                  */
+    u_int        nfiles;
+    u_int        next;      /* Next file to deliver                   */
+    u_int        started;   /* Files [next, started) have been queued */
+    u_int        depth;
+    ingestSlot  *slots;
+    Status       ret;
+
+    uRing            ring;
+
+    pthread_t        threads[INGEST_POOL_MAX];
+    u_int            nthreads;
+    pthread_mutex_t  lock;
+    pthread_cond_t   work;      /* Pool threads: a file came in range */
+    pthread_cond_t   done;      /* Reader: file `waiting` has landed  */
+    u_int            waiting;
+    u_int            claim;     /* Next file a pool thread may take   */
+    u_int            limit;     /* Pool threads stay below this index */
+    int              stop;
+
+    int              hashing;   /* Hash each document's content       */
+    char            *scratch;   /* Unhashed tail of a streamed doc    */
+    size_t           fill;      /* Bytes held in scratch              */
+    FILE            *in;        /* Stream under the hashing one       */
+    int              at_end;    /* in was read to its end             */
+    uint64_t         hash;      /* Content hash of the current doc    */
+    size_t           hash_len;  /* Bytes hashed so far                */
+    int              hashed;    /* hash and hash_len are final        */
+    int              held;      /* scratch holds the whole document   */
+
+    FILE            *ahead;     /* Stream opened ahead of its turn    */
+    u_int            ahead_at;  /* Its file index                     */
+    int              has_ahead;
+};
+
+/* ─────────────────────────────────────────────
+ *  io_uring backend
+ * ───────────────────────────────────────────── */
+
+static int sys_uring_setup(u_int entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_uring_enter(int fd, u_int submit, u_int wait, u_int flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0);
+}
+
+static int sys_uring_register(int fd, u_int op, void *arg, u_int nargs)
+{
+    return (int)syscall(__NR_io_uring_register, fd, op, arg, nargs);
+}
+
+static void ring_free(uRing *r)
+{
+    if(r->sqes)
+        munmap(r->sqes, r->sqes_size);
+    if(r->cq_ptr && r->cq_ptr != r->sq_ptr)
+        munmap(r->cq_ptr, r->cq_size);
+    if(r->sq_ptr)
+        munmap(r->sq_ptr, r->sq_size);
+    if(r->fd >= 0)
+        close(r->fd);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
+}
+
+/**
+ * @brief  Whether the kernel supports every opcode the reader needs.
+ */
+static int ring_probe(int fd)
+{
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, size);
+    if(probe == NULL)
+        return 0;
+
+    int ok = sys_uring_register(fd, IORING_REGISTER_PROBE, probe, 256) == 0
+             && probe->last_op >= IORING_OP_READ
+             && (probe->ops[IORING_OP_OPENAT].flags & IO_URING_OP_SUPPORTED)
+             && (probe->ops[IORING_OP_READ].flags   & IO_URING_OP_SUPPORTED)
+             && (probe->ops[IORING_OP_CLOSE].flags  & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return ok;
+}
+
+/**
+ * @brief  Writes the next SQE; the caller keeps queued + inflight <= entries.
+ */
+static struct io_uring_sqe *ring_sqe(uRing *r)
+{
+    u_int tail = *r->sq_tail;
+    u_int idx  = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    (r->queued)++;
+    return sqe;
+}
+
+/**
+ * @brief  Opens and closes "." through direct descriptor 0.
+ *
+ * The opcode probe cannot tell whether OPENAT / CLOSE accept a direct
+ * descriptor (Linux 5.15+); an older kernel fails this instead of every
+ * document.
+ */
+static Status ring_selftest(uRing *r)
+{
+    struct io_uring_sqe *sqe = ring_sqe(r);
+    sqe->opcode     = IORING_OP_OPENAT;
+    sqe->fd         = AT_FDCWD;
+    sqe->addr       = (uintptr_t)".";
+    sqe->open_flags = O_RDONLY | O_DIRECTORY;
+    sqe->file_index = 1;
+    sqe->flags      = IOSQE_IO_LINK;
+
+    sqe = ring_sqe(r);
+    sqe->opcode     = IORING_OP_CLOSE;
+    sqe->file_index = 1;
+
+    if(sys_uring_enter(r->fd, 2, 2, IORING_ENTER_GETEVENTS) != 2)
+        return FAILURE;
+    r->queued = 0;
+
+    Status ret  = SUCCESS;
+    u_int  head = *r->cq_head;
+    for(int i = 0; i < 2; i++, head++)
+    {
+        while(head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE))
+            if(sys_uring_enter(r->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+                return FAILURE;
+        if(r->cqes[head & *r->cq_mask].res < 0)
+            ret = FAILURE;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    return ret;
+}
+
+/**
+ * @brief  Sets up a ring of at least `entries` SQEs with `nfixed` empty
+ *         direct-descriptor slots.
+ * @return SUCCESS, or FAILURE if io_uring is unavailable.
+ */
+static Status ring_init(uRing *r, u_int entries, u_int nfixed)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+
+    r->fd = sys_uring_setup(entries, &p);
+    if(r->fd < 0 || !ring_probe(r->fd))
+    {
+        ring_free(r);
+        return FAILURE;
+    }
+    r->entries = p.sq_entries;
+
+    /* ── Map the SQ / CQ rings (one mapping when the kernel allows it) ── */
+    r->sq_size = p.sq_off.array + p.sq_entries * sizeof(u_int);
+    r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if(p.features & IORING_FEAT_SINGLE_MMAP)
+        r->sq_size = r->cq_size = (r->sq_size > r->cq_size) ? r->sq_size : r->cq_size;
+
+    r->sq_ptr = mmap(NULL, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     r->fd, IORING_OFF_SQ_RING);
+    if(r->sq_ptr == MAP_FAILED)
+    {
+        r->sq_ptr = NULL;
+        ring_free(r);
+        return FAILURE;
+    }
+    if(p.features & IORING_FEAT_SINGLE_MMAP)
+        r->cq_ptr = r->sq_ptr;
+    else
+    {
+        r->cq_ptr = mmap(NULL, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         r->fd, IORING_OFF_CQ_RING);
+        if(r->cq_ptr == MAP_FAILED)
+        {
+            r->cq_ptr = NULL;
+            ring_free(r);
+            return FAILURE;
+        }
+    }
+
+    r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->fd, IORING_OFF_SQES);
+    if(r->sqes == MAP_FAILED)
+    {
+        r->sqes = NULL;
+        ring_free(r);
+        return FAILURE;
+    }
+
+    char *sq = r->sq_ptr, *cq = r->cq_ptr;
+    r->sq_head  = (u_int *)(sq + p.sq_off.head);
+    r->sq_tail  = (u_int *)(sq + p.sq_off.tail);
+    r->sq_mask  = (u_int *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (u_int *)(sq + p.sq_off.array);
+    r->cq_head  = (u_int *)(cq + p.cq_off.head);
+    r->cq_tail  = (u_int *)(cq + p.cq_off.tail);
+    r->cq_mask  = (u_int *)(cq + p.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    /* ── Empty direct-descriptor table: slot s opens into index s ── */
+    int *fds = malloc(nfixed * sizeof(int));
+    if(fds == NULL)
+    {
+        ring_free(r);
+        return FAILURE;
+    }
+    for(u_int i = 0; i < nfixed; i++)
+        fds[i] = -1;
+    int reg = sys_uring_register(r->fd, IORING_REGISTER_FILES, fds, nfixed);
+    free(fds);
+    if(reg < 0 || ring_selftest(r) == FAILURE)
+    {
+        ring_free(r);
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief  Queues file j as open → read → close into slot s's direct
+ *         descriptor. Hard links keep the chain going after a short
+ *         read; an open error surfaces as -EBADF on the later two.
+ */
+static void ring_queue_doc(ingestReader *br, u_int j)
+{
+    u_int       s    = j % br->depth;
+    ingestSlot *slot = &br->slots[s];
+    uint64_t    tag  = (uint64_t)j << 2;
+
+    struct io_uring_sqe *sqe = ring_sqe(&br->ring);
+    sqe->opcode     = IORING_OP_OPENAT;
+    sqe->fd         = AT_FDCWD;
+    sqe->addr       = (uintptr_t)br->files[j]->file_name;
+    sqe->open_flags = O_RDONLY;         /* O_CLOEXEC is invalid for direct opens */
+    sqe->file_index = s + 1;
+    sqe->flags      = IOSQE_IO_HARDLINK;
+    sqe->user_data  = tag | URING_OP_OPEN;
+
+    sqe = ring_sqe(&br->ring);
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = s;
+    sqe->addr      = (uintptr_t)slot->buf;
+    sqe->len       = INGEST_DOC_MAX;
+    sqe->off       = 0;
+    sqe->flags     = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    sqe->user_data = tag | URING_OP_READ;
+
+    sqe = ring_sqe(&br->ring);
+    sqe->opcode     = IORING_OP_CLOSE;
+    sqe->file_index = s + 1;
+    sqe->user_data  = tag | URING_OP_CLOSE;
+
+    slot->pending = 3;
+}
+
+/**
+ * @brief  Consumes every available completion and settles finished slots.
+ */
+static void ring_reap(ingestReader *br)
+{
+    uRing *r    = &br->ring;
+    u_int  head = *r->cq_head;
+
+    while(head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE))
+    {
+        struct io_uring_cqe *cqe  = &r->cqes[head & *r->cq_mask];
+        u_int                j    = (u_int)(cqe->user_data >> 2);
+        ingestSlot          *slot = &br->slots[j % br->depth];
+
+        switch(cqe->user_data & 3)
+        {
+            case URING_OP_OPEN: slot->open_res = cqe->res; break;
+            case URING_OP_READ: slot->read_res = cqe->res; break;
+            default:            break;
+        }
+
+        if(--(slot->pending) == 0)
+        {
+            if(slot->open_res < 0 || slot->read_res < 0)
+                slot->state = SLOT_FAILED;
+            else if(slot->read_res == INGEST_DOC_MAX)
+                slot->state = SLOT_STREAM;      /* May be longer — stream it */
+            else
+            {
+                slot->len   = slot->read_res;
+                slot->state = SLOT_READY;
+            }
+        }
+        head++;
+        (r->inflight)--;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief  Submits what is queued; with wait, blocks for one completion.
+ */
+static Status ring_submit(uRing *r, int wait)
+{
+    int n = sys_uring_enter(r->fd, r->queued, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0);
+    if(n < 0)
+        return (errno == EINTR || errno == EAGAIN || errno == EBUSY) ? SUCCESS : FAILURE;
+    r->queued   -= n;
+    r->inflight += n;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Fills the window with new chains and waits until file i settles.
+ */
+static Status uring_wait(ingestReader *br, u_int i)
+{
+    uRing *r = &br->ring;
+
+    while(1)
+    {
+        while(br->started < br->nfiles && br->started < i + br->depth
+              && r->queued + r->inflight + 3 <= r->entries)
+        {
+            u_int       j    = br->started++;
+            ingestSlot *slot = &br->slots[j % br->depth];
+            slot->file  = j;
+            slot->state = SLOT_PENDING;
+            if(document_format(br->files[j]->file_name) != DOC_PLAIN)
+                slot->state = SLOT_STREAM;
+            else
+                ring_queue_doc(br, j);
+        }
+
+        if(br->slots[i % br->depth].state != SLOT_PENDING)
+            return r->queued ? ring_submit(r, 0) : SUCCESS;
+
+        if(ring_submit(r, 1) == FAILURE)
+            return FAILURE;
+        ring_reap(br);
+    }
+}
+
+/**
+ * @brief  Waits for every queued or in-flight operation to complete, so
+ *         no read can land in a buffer after it is freed.
+ */
+static void uring_drain(ingestReader *br)
+{
+    while(br->ring.queued || br->ring.inflight)
+    {
+        if(ring_submit(&br->ring, br->ring.inflight || br->ring.queued) == FAILURE)
+            break;
+        ring_reap(br);
+    }
+}
+
+/* ─────────────────────────────────────────────
+ *  Thread-pool backend
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Reads file j whole into its slot with blocking syscalls.
+ */
+static SlotState read_whole(const char *fname, ingestSlot *slot)
+{
+    if(document_format(fname) != DOC_PLAIN)
+        return SLOT_STREAM;
+
+    int fd = open(fname, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return SLOT_FAILED;
+
+    size_t len = 0;
+    while(len < INGEST_DOC_MAX)
+    {
+        ssize_t n = read(fd, slot->buf + len, INGEST_DOC_MAX - len);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n < 0)
+        {
+            close(fd);
+            return SLOT_FAILED;
+        }
+        if(n == 0)
+            break;
+        len += n;
+    }
+    close(fd);
+
+    slot->len = len;
+    return (len == INGEST_DOC_MAX) ? SLOT_STREAM : SLOT_READY;
+}
+
+static void *pool_worker(void *arg)
+{
+    ingestReader *br = arg;
+
+    while(1)
+    {
+        pthread_mutex_lock(&br->lock);
+        while(!br->stop && br->claim < br->nfiles && br->claim >= br->limit)
+            pthread_cond_wait(&br->work, &br->lock);
+        if(br->stop || br->claim >= br->nfiles)
+        {
+            pthread_mutex_unlock(&br->lock);
+            return NULL;
+        }
+        u_int       j    = br->claim++;
+        ingestSlot *slot = &br->slots[j % br->depth];
+        slot->file  = j;
+        slot->state = SLOT_PENDING;
+        pthread_mutex_unlock(&br->lock);
+
+        /* Slot j % depth is free: file j - depth was delivered and closed */
+        SlotState state = read_whole(br->files[j]->file_name, slot);
+
+        pthread_mutex_lock(&br->lock);
+        slot->state = state;
+        if(br->waiting == j)
+            pthread_cond_signal(&br->done);
+        pthread_mutex_unlock(&br->lock);
+    }
+}
+
+static void pool_wait(ingestReader *br, u_int i)
+{
+    ingestSlot *slot = &br->slots[i % br->depth];
+
+    pthread_mutex_lock(&br->lock);
+    if(br->limit < i + br->depth)
+    {
+        br->limit = i + br->depth;          /* Slot of file i - 1 is free */
+        pthread_cond_signal(&br->work);
+    }
+    br->waiting = i;
+    while(slot->file != i || slot->state == SLOT_PENDING)
+        pthread_cond_wait(&br->done, &br->lock);
+    pthread_mutex_unlock(&br->lock);
+}
+
+static void pool_stop(ingestReader *br)
+{
+    pthread_mutex_lock(&br->lock);
+    br->stop = 1;
+    pthread_cond_broadcast(&br->work);
+    pthread_mutex_unlock(&br->lock);
+    for(u_int t = 0; t < br->nthreads; t++)
+        pthread_join(br->threads[t], NULL);
+    pthread_mutex_destroy(&br->lock);
+    pthread_cond_destroy(&br->work);
+    pthread_cond_destroy(&br->done);
+}
+
+/* ─────────────────────────────────────────────
+ *  Reader
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Whether file j is streamed rather than batched (known up front).
+ */
+static int is_stream(ingestReader *br, u_int j)
+{
+    return br->mode == INGEST_SERIAL || document_format(br->files[j]->file_name) != DOC_PLAIN;
+}
+
+/**
+ * @brief  Opens the first streamed document after file i ahead of time,
+ *         so a compressed one decodes while file i is tokenized.
+ */
+static void open_ahead(ingestReader *br, u_int i)
+{
+    if(br->has_ahead)
+        return;
+    for(u_int j = i + 1; j < br->nfiles && j <= i + br->depth; j++)
+    {
+        if(is_stream(br, j))
+        {
+            br->ahead     = open_document(br->files[j]->file_name);
+            br->ahead_at  = j;
+            br->has_ahead = 1;
+            return;
+        }
+    }
+}
+
+/* ─────────────────────────────────────────────
+ *  Hashing stream — hashes a streamed document
+ *  as the caller reads it, in INGEST_DOC_MAX chunks
+ *  like a batched document's single buffer.
+ * ───────────────────────────────────────────── */
+
+static void hash_feed(ingestReader *br, const char *data, size_t n)
+{
+    while(n)
+    {
+        /* A whole chunk straight from the caller's buffer */
+        if(br->fill == 0 && n >= INGEST_DOC_MAX)
+        {
+            br->hash      = hash_bytes(data, INGEST_DOC_MAX, br->hash);
+            br->hash_len += INGEST_DOC_MAX;
+            data += INGEST_DOC_MAX;
+            n    -= INGEST_DOC_MAX;
+            continue;
+        }
+
+        size_t take = INGEST_DOC_MAX - br->fill;
+        if(take > n)
+            take = n;
+        memcpy(br->scratch + br->fill, data, take);
+        br->fill += take;
+        data     += take;
+        n        -= take;
+        if(br->fill == INGEST_DOC_MAX)
+        {
+            br->hash      = hash_bytes(br->scratch, INGEST_DOC_MAX, br->hash);
+            br->hash_len += INGEST_DOC_MAX;
+            br->fill      = 0;
+        }
+    }
+}
+
+static ssize_t hash_read(void *cookie, char *buf, size_t size)
+{
+    ingestReader *br = cookie;
+    size_t        n  = fread(buf, 1, size, br->in);
+
+    if(n == 0)
+    {
+        if(ferror(br->in))
+            return -1;
+        br->at_end = 1;
+    }
+    hash_feed(br, buf, n);
+    return n;
+}
+
+static int hash_close(void *cookie)
+{
+    ingestReader *br = cookie;
+
+    /* The last, partial chunk; an empty document is one empty chunk */
+    if(br->at_end)
+    {
+        br->held = br->hash_len == 0;
+        if(br->fill || br->hash_len == 0)
+            br->hash = hash_bytes(br->scratch, br->fill, br->hash);
+        br->hash_len += br->fill;
+        br->hashed    = 1;
+    }
+    return fclose(br->in);
+}
+
+/**
+ * @brief  Layers the hashing stream over a streamed document.
+ * @return The new stream, or NULL (with in closed) on failure.
+ */
+static FILE *hash_stream(ingestReader *br, FILE *in)
+{
+    if(br->scratch == NULL && (br->scratch = malloc(INGEST_DOC_MAX)) == NULL)
+    {
+        fclose(in);
+        return NULL;
+    }
+
+    cookie_io_functions_t io = { hash_read, NULL, NULL, hash_close };
+    FILE *fp = fopencookie(br, "r", io);
+    if(fp == NULL)
+    {
+        fclose(in);
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, INGEST_DOC_MAX);     /* One chunk per refill */
+
+    br->in       = in;
+    br->fill     = 0;
+    br->at_end   = 0;
+    br->hash     = 0;
+    br->hash_len = 0;
+    return fp;
+}
+
+/**
+ * @brief  Whether io_uring can be used by this process.
+ */
+int ingest_uring_available(void)
+{
+    uRing r;
+    if(ring_init(&r, 4, 1) == FAILURE)
+        return 0;
+    ring_free(&r);
+    return 1;
+}
+
+/**
+ * @brief  Starts reading the files of an Flist.
+ *
+ * @param  head   First file to read.
+ * @param  mode   Backend; INGEST_AUTO picks io_uring, then the thread
+ *                pool, and the serial loop for a single file. A backend
+ *                that cannot start falls back the same way.
+ * @param  depth  Documents in flight (0 = INGEST_DEPTH).
+ * @param  hash   Non-zero to hash every document (see ingest_hash).
+ * @return The reader, or NULL on malloc failure.
+ */
+ingestReader *ingest_open(Flist *head, IngestMode mode, u_int depth, int hash)
+{
+    ingestReader *br = calloc(1, sizeof(ingestReader));
+    if(br == NULL)
+        return NULL;
+    br->ring.fd = -1;
+    br->hashing = hash;
+
+    for(Flist *temp = head; temp; temp = temp->link)
+        br->nfiles++;
+    br->files = malloc((br->nfiles ? br->nfiles : 1) * sizeof(Flist *));
+    if(br->files == NULL)
+    {
+        free(br);
+        return NULL;
+    }
+    br->nfiles = 0;
+    for(Flist *temp = head; temp; temp = temp->link)
+        br->files[br->nfiles++] = temp;
+
+    if(depth == 0)
+        depth = INGEST_DEPTH;
+    if(depth > INGEST_DEPTH_MAX)
+        depth = INGEST_DEPTH_MAX;
+    if(mode == INGEST_AUTO && br->nfiles <= 1)
+        mode = INGEST_SERIAL;
+
+    if(mode != INGEST_SERIAL)
+    {
+        br->depth = depth;
+        br->slots = calloc(depth, sizeof(ingestSlot));
+        for(u_int s = 0; br->slots && s < depth; s++)
+        {
+            br->slots[s].buf = malloc(INGEST_DOC_MAX);
+            if(br->slots[s].buf == NULL)
+                mode = INGEST_SERIAL;
+        }
+        if(br->slots == NULL)
+            mode = INGEST_SERIAL;
+    }
+
+    /* ── Start the backend, falling back uring → threads → serial ── */
+    if((mode == INGEST_URING || mode == INGEST_AUTO)
+       && ring_init(&br->ring, 4 * depth, depth) == SUCCESS)
+        mode = INGEST_URING;
+    else if(mode == INGEST_URING || mode == INGEST_AUTO)
+        mode = INGEST_THREADS;
+
+    if(mode == INGEST_THREADS)
+    {
+        pthread_mutex_init(&br->lock, NULL);
+        pthread_cond_init(&br->work, NULL);
+        pthread_cond_init(&br->done, NULL);
+        br->limit = depth;
+        u_int want = depth < INGEST_POOL_MAX ? depth : INGEST_POOL_MAX;
+        while(br->nthreads < want
+              && pthread_create(&br->threads[br->nthreads], NULL, pool_worker, br) == 0)
+            br->nthreads++;
+        if(br->nthreads == 0)
+        {
+            pthread_mutex_destroy(&br->lock);
+            pthread_cond_destroy(&br->work);
+            pthread_cond_destroy(&br->done);
+            mode = INGEST_SERIAL;
+        }
+    }
+
+    if(mode == INGEST_SERIAL)
+    {
+        br->depth = 1;
+        if(br->nfiles)
+        {
+            br->ahead     = open_document(br->files[0]->file_name);
+            br->ahead_at  = 0;
+            br->has_ahead = 1;
+        }
+    }
+
+    br->mode = mode;
+    br->ret  = SUCCESS;
+    return br;
+}
+
+/**
+ * @brief  Returns the next document, in Flist order, as a read stream.
+ *
+ * The caller must fclose the stream before asking for the next one.
+ *
+ * @param  file  Receives the document's Flist node.
+ * @return The stream, or NULL once every document was returned or after
+ *         an error (see ingest_close).
+ */
+FILE *ingest_next(ingestReader *br, Flist **file)
+{
+    if(br->ret != SUCCESS || br->next >= br->nfiles)
+        return NULL;
+
+    u_int i  = br->next;
+    FILE *fp = NULL;
+
+    if(br->mode == INGEST_URING && uring_wait(br, i) == FAILURE)
+    {
+        br->ret = FAILURE;
+        return NULL;
+    }
+    if(br->mode == INGEST_THREADS)
+        pool_wait(br, i);
+
+    if(br->has_ahead && br->ahead_at == i)
+    {
+        fp = br->ahead;
+        br->has_ahead = 0;
+    }
+    else
+    {
+        ingestSlot *slot = &br->slots[i % br->depth];
+        if(slot->state == SLOT_READY && slot->len)
+            fp = fmemopen(slot->buf, slot->len, "r");
+        else if(slot->state != SLOT_FAILED)
+            fp = open_document(br->files[i]->file_name);   /* Streamed, or empty */
+    }
+
+    /* ── Content hash: from the buffer if batched, else while it is read ── */
+    br->hashed = br->held = 0;
+    if(fp && br->hashing)
+    {
+        ingestSlot *slot = br->mode == INGEST_SERIAL ? NULL : &br->slots[i % br->depth];
+        if(slot && slot->state == SLOT_READY)
+        {
+            br->hash     = hash_bytes(slot->buf, slot->len, 0);
+            br->hash_len = slot->len;
+            br->hashed   = 1;
+        }
+        else
+            fp = hash_stream(br, fp);
+    }
+
+    open_ahead(br, i);
+
+    if(fp == NULL)
+    {
+        br->ret = FAILURE;
+        return NULL;
+    }
+    br->next++;
+    *file = br->files[i];
+    return fp;
+}
+
+/**
+ * @brief  Content hash and size of the document last returned by
+ *         ingest_next, on a reader opened with hash set.
+ *
+ * A batched document's hash is known at once; a streamed one's only once
+ * its stream has been read to the end and closed.
+ *
+ * @return SUCCESS, or FAILURE if the hash is not known (yet).
+ */
+Status ingest_hash(const ingestReader *br, uint64_t *hash, size_t *len)
+{
+    if(!br->hashed)
+        return FAILURE;
+    *hash = br->hash;
+    *len  = br->hash_len;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Bytes of the document last returned by ingest_next, if they are
+ *         held in memory; valid until the next call to ingest_next.
+ *
+ * A batched document is held from the start. A streamed one shorter than
+ * INGEST_DOC_MAX is held once ingest_hash knows its hash.
+ *
+ * @param  len  Receives their count.
+ * @return The buffer, or NULL if the document is not held.
+ */
+const char *ingest_buffer(const ingestReader *br, size_t *len)
+{
+    if(br->held)
+    {
+        *len = br->hash_len;
+        return br->scratch;
+    }
+    if(br->mode == INGEST_SERIAL || br->next == 0)
+        return NULL;
+
+    const ingestSlot *slot = &br->slots[(br->next - 1) % br->depth];
+    if(slot->file != br->next - 1 || slot->state != SLOT_READY)
+        return NULL;
+    *len = slot->len;
+    return slot->buf;
+}
+
+/**
+ * @brief  Stops the reader and frees it.
+ * @return SUCCESS, or FAILURE if any document could not be read.
+ */
+Status ingest_close(ingestReader *br)
+{
+    if(br == NULL)
+        return SUCCESS;
+
+    Status ret = br->ret;
+    if(br->mode == INGEST_URING)
+    {
+        uring_drain(br);
+        ring_free(&br->ring);
+    }
+    if(br->mode == INGEST_THREADS)
+        pool_stop(br);
+    if(br->has_ahead && br->ahead)
+        fclose(br->ahead);
+
+    for(u_int s = 0; br->slots && s < br->depth; s++)
+        free(br->slots[s].buf);
+    free(br->scratch);
+    free(br->slots);
+    free(br->files);
+    free(br);
+    return ret;
+}
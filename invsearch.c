@@ -0,0 +1,673 @@
+/**
+ * @file   invsearch.c
+ * @brief  Public API of libinvsearch (see invsearch.h).
+ *
+ * A thin layer over the internal modules: it owns the per-index state
+ * (struct invIndex), translates internal Status codes to InvStatus, and
+ * adapts the internal match_fn results — one or more mNodes per word — to
+ * the flat InvHit handed to the caller.
+ *
+ * Builds are incremental: idx->indexed marks the last file already merged
+ * into the hash table, so inv_build only reads the files added since.
+ */
+
+#include "main.h"
+
+#define INV_SAVE_MAGIC  "INVSEARCH 3"   /* First line of an inv_save file */
+
+/* ─────────────────────────────────────────────
+ *  emitCtx — Adapts match_fn results to InvHitFn
+ *  posts[] is scratch space reused for every hit.
+ *  With docs set, each posting is followed by one
+ *  per alias of its file, with the same count.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    InvHitFn        fn;
+    void           *ctx;
+    const docTable *docs;       /* NULL = postings as stored         */
+    InvPosting     *posts;
+    size_t          cap;
+    int             failed;     /* Set if posts[] could not grow     */
+} emitCtx;
+
+static InvStatus to_inv_status(Status ret)
+{
+    switch(ret)
+    {
+        case SUCCESS:        return INV_SUCCESS;
+        case DATA_NOT_FOUND: return INV_NOT_FOUND;
+        case DUPLICATE:      return INV_DUPLICATE;
+        case NOT_TXT_FILE:   return INV_NOT_TXT;
+        case FILE_NOT_OPEN:  return INV_NO_FILE;
+        case FILE_EMPTY:     return INV_EMPTY_FILE;
+        case LIST_EMPTY:     return INV_NOT_BUILT;
+        case UNSUPPORTED:    return INV_UNSUPPORTED;
+        default:             return INV_FAILURE;
+    }
+}
+
+/**
+ * @brief  Appends one posting to the scratch array, growing it as needed.
+ */
+static int emit_post(emitCtx *e, InvHit *hit, const char *file_name, u_int count)
+{
+    if(hit->filecount == e->cap)
+    {
+        size_t      new_cap = e->cap ? e->cap * 2 : 16;
+        InvPosting *grown   = realloc(e->posts, new_cap * sizeof(InvPosting));
+        if(grown == NULL)
+        {
+            e->failed = 1;
+            return 1;
+        }
+        e->posts = grown;
+        e->cap   = new_cap;
+    }
+    e->posts[hit->filecount].file_name = file_name;
+    e->posts[hit->filecount].count     = count;
+    hit->filecount++;
+    hit->total += count;
+    return 0;
+}
+
+/**
+ * @brief  match_fn that flattens a word's mNodes into one InvHit.
+ */
+static int emit_hit(mNode **nodes, u_int nnodes, u_int dist, void *arg)
+{
+    emitCtx *e = arg;
+
+    InvHit hit = { nodes[0]->word, bucket_index(nodes[0]->word), 0, 0, dist, NULL };
+    for(u_int i = 0; i < nnodes; i++)
+    {
+        for(sNode *sTemp = nodes[i]->sLink; sTemp; sTemp = sTemp->subLink)
+        {
+            if(emit_post(e, &hit, sTemp->file_name, sTemp->wordcount))
+                return 1;
+
+            /* Identical copies were not indexed; report them here */
+            const Flist *alias = e->docs ? dedup_aliases(e->docs, sTemp->file_name) : NULL;
+            for(; alias; alias = alias->link)
+                if(emit_post(e, &hit, alias->file_name, sTemp->wordcount))
+                    return 1;
+        }
+    }
+    hit.postings = e->posts;
+    return e->fn(&hit, e->ctx);
+}
+
+/**
+ * @brief  Frees the emit scratch space and folds its failure into ret.
+ */
+static InvStatus emit_done(emitCtx *e, Status ret)
+{
+    free(e->posts);
+    return e->failed ? INV_FAILURE : to_inv_status(ret);
+}
+
+/**
+ * @brief  Empties the index back to the state inv_create returns.
+ */
+static void inv_clear(InvIndex *idx)
+{
+    free_hash_table(idx->table);
+    initialize_hashTable(idx->table);
+    free_list(&idx->files);
+    idx->indexed = NULL;
+    free_shards(&idx->shards);
+    free_trigram_index(&idx->tri);
+    free_fuzzy_index(&idx->fuzzy);
+    dedup_free(&idx->docs);
+}
+
+/* ─────────────────────────────────────────────
+ *  Lifecycle
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Allocates an empty index.
+ * @return The index, or NULL on malloc failure.
+ */
+InvIndex *inv_create(void)
+{
+    InvIndex *idx = calloc(1, sizeof(InvIndex));
+    if(idx == NULL)
+        return NULL;
+
+    initialize_hashTable(idx->table);
+    idx->shards.mode = SHARD_BY_DOC;
+    idx->ingest      = INGEST_AUTO;
+    idx->tri.stale   = 1;
+    idx->fuzzy.stale = 1;
+    return idx;
+}
+
+/**
+ * @brief  Frees the index and everything it owns. Accepts NULL.
+ */
+void inv_destroy(InvIndex *idx)
+{
+    if(idx == NULL)
+        return;
+    inv_clear(idx);
+    free(idx);
+}
+
+/* ─────────────────────────────────────────────
+ *  Building
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Validates a file and queues it for the next inv_build.
+ *
+ * Plain ".txt" files and compressed ".txt.gz" (and, if built in,
+ * ".txt.zst") files are accepted; compressed ones are decompressed
+ * while they are indexed, never to disk.
+ *
+ * @return INV_SUCCESS, or INV_NOT_TXT / INV_UNSUPPORTED / INV_NO_FILE /
+ *         INV_EMPTY_FILE / INV_DUPLICATE for a rejected file, INV_FAILURE
+ *         on malloc failure.
+ */
+InvStatus inv_add_file(InvIndex *idx, const char *file_name)
+{
+    if(idx == NULL || file_name == NULL)
+        return INV_BAD_ARGUMENT;
+    return to_inv_status(read_and_validation(file_name, &idx->files));
+}
+
+/**
+ * @brief  Chooses how inv_build and inv_build_external read documents.
+ *
+ * Batched modes keep up to depth documents being opened and read while
+ * earlier ones are indexed; the resulting index is the same in every mode.
+ *
+ * @param  depth  Documents in flight, 1 .. INV_MAX_INGEST_DEPTH (0 = default).
+ * @return INV_SUCCESS, INV_BAD_ARGUMENT, or INV_UNSUPPORTED for
+ *         INV_INGEST_URING when io_uring cannot be used.
+ */
+InvStatus inv_set_ingest(InvIndex *idx, InvIngestMode mode, unsigned int depth)
+{
+    IngestMode im;
+
+    if(idx == NULL || depth > INV_MAX_INGEST_DEPTH)
+        return INV_BAD_ARGUMENT;
+    switch(mode)
+    {
+        case INV_INGEST_AUTO:    im = INGEST_AUTO;    break;
+        case INV_INGEST_SERIAL:  im = INGEST_SERIAL;  break;
+        case INV_INGEST_THREADS: im = INGEST_THREADS; break;
+        case INV_INGEST_URING:   im = INGEST_URING;   break;
+        default:                 return INV_BAD_ARGUMENT;
+    }
+    if(im == INGEST_URING && !ingest_uring_available())
+        return INV_UNSUPPORTED;
+
+    idx->ingest       = im;
+    idx->ingest_depth = depth;
+    return INV_SUCCESS;
+}
+
+/**
+ * @brief  Indexes every file added since the last build.
+ *
+ * A file whose bytes are identical to an indexed one is not indexed again;
+ * results list it as an alias, with the same counts as the original.
+ *
+ * If a file fails, the files before it stay indexed and the next call
+ * resumes at the failed file.
+ *
+ * @return INV_SUCCESS (also when there was nothing new), INV_FAILURE if a
+ *         file could not be read or an allocation failed.
+ */
+InvStatus inv_build(InvIndex *idx)
+{
+    if(idx == NULL)
+        return INV_BAD_ARGUMENT;
+
+    Flist *start = idx->indexed ? idx->indexed->link : idx->files;
+    if(start == NULL)
+        return INV_SUCCESS;
+
+    idx->tri.stale = idx->fuzzy.stale = 1;
+    return to_inv_status(create_database(idx->table, start, idx->ingest, idx->ingest_depth,
+                                         &idx->docs, &idx->indexed));
+}
+
+/**
+ * @brief  Builds an index of every added file directly on disk, holding
+ *         at most about budget bytes in RAM (see external_database.c).
+ *
+ * The in-memory index is not touched.
+ *
+ * @param  runs  If not NULL, receives the number of runs spilled.
+ */
+InvStatus inv_build_external(InvIndex *idx, size_t budget, const char *out_path, unsigned int *runs)
+{
+    if(idx == NULL || out_path == NULL)
+        return INV_BAD_ARGUMENT;
+    return to_inv_status(create_database_external(idx->files, budget, idx->ingest, idx->ingest_depth,
+                                                  out_path, runs));
+}
+
+/**
+ * @brief  (Re)builds nshards shards of every added file in parallel.
+ */
+InvStatus inv_build_shards(InvIndex *idx, unsigned int nshards, InvShardMode mode)
+{
+    if(idx == NULL || nshards == 0 || nshards > INV_MAX_SHARDS
+       || (mode != INV_SHARD_BY_DOC && mode != INV_SHARD_BY_TERM))
+        return INV_BAD_ARGUMENT;
+    return to_inv_status(build_shards(&idx->shards, idx->files, nshards,
+                                      mode == INV_SHARD_BY_DOC ? SHARD_BY_DOC : SHARD_BY_TERM));
+}
+
+/* ─────────────────────────────────────────────
+ *  Querying
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Reports every word starting with prefix (case-insensitive).
+ */
+InvStatus inv_search(InvIndex *idx, const char *prefix, InvHitFn fn, void *ctx)
+{
+    if(idx == NULL || prefix == NULL || fn == NULL)
+        return INV_BAD_ARGUMENT;
+
+    emitCtx e = { fn, ctx, &idx->docs, NULL, 0, 0 };
+    return emit_done(&e, search_database(idx->table, prefix, emit_hit, &e));
+}
+
+/**
+ * @brief  Reports every word matching a '*' / '?' pattern, or containing
+ *         it when it has no wildcard.
+ */
+InvStatus inv_search_wildcard(InvIndex *idx, const char *pattern, InvHitFn fn, void *ctx)
+{
+    if(idx == NULL || pattern == NULL || fn == NULL)
+        return INV_BAD_ARGUMENT;
+
+    emitCtx e = { fn, ctx, &idx->docs, NULL, 0, 0 };
+    return emit_done(&e, search_wildcard(&idx->tri, idx->table, pattern, emit_hit, &e));
+}
+
+/**
+ * @brief  Reports words within max_dist edits of word, closest and most
+ *         widespread first; InvHit.distance holds each one's distance.
+ */
+InvStatus inv_search_fuzzy(InvIndex *idx, const char *word, unsigned int max_dist, InvHitFn fn, void *ctx)
+{
+    if(idx == NULL || word == NULL || fn == NULL || max_dist == 0 || max_dist > INV_MAX_FUZZY_DIST)
+        return INV_BAD_ARGUMENT;
+
+    emitCtx e = { fn, ctx, &idx->docs, NULL, 0, 0 };
+    return emit_done(&e, search_fuzzy(&idx->fuzzy, idx->table, word, max_dist, emit_hit, &e));
+}
+
+/**
+ * @brief  Prefix search over the shards built by inv_build_shards.
+ *
+ * @param  topk      Report only the k words with the most occurrences
+ *                   (0 = every match, alphabetically).
+ * @param  nmatched  If not NULL, receives the number of matching words
+ *                   before the top-k cut.
+ * @return INV_NOT_BUILT if no shards were built.
+ */
+InvStatus inv_search_shards(InvIndex *idx, const char *prefix, unsigned int topk,
+                            InvHitFn fn, void *ctx, unsigned int *nmatched)
+{
+    if(idx == NULL || prefix == NULL || fn == NULL)
+        return INV_BAD_ARGUMENT;
+
+    emitCtx e = { fn, ctx, NULL, NULL, 0, 0 };   /* Shards index every copy */
+    return emit_done(&e, search_shards(&idx->shards, prefix, topk, emit_hit, &e, nmatched));
+}
+
+/**
+ * @brief  Reports every word of the index, bucket by bucket.
+ */
+InvStatus inv_foreach_term(InvIndex *idx, InvHitFn fn, void *ctx)
+{
+    if(idx == NULL || fn == NULL)
+        return INV_BAD_ARGUMENT;
+
+    emitCtx e = { fn, ctx, &idx->docs, NULL, 0, 0 };
+    for(int i = 0; i < 27; i++)
+        for(mNode *mTemp = idx->table[i].link; mTemp; mTemp = mTemp->mLink)
+            if(emit_hit(&mTemp, 1, 0, &e))
+                return emit_done(&e, SUCCESS);
+    return emit_done(&e, SUCCESS);
+}
+
+/**
+ * @brief  Reports every added file in insertion order.
+ */
+InvStatus inv_foreach_file(InvIndex *idx, InvFileFn fn, void *ctx)
+{
+    if(idx == NULL || fn == NULL)
+        return INV_BAD_ARGUMENT;
+
+    for(Flist *temp = idx->files; temp; temp = temp->link)
+        if(fn(temp->file_name, ctx))
+            break;
+    return INV_SUCCESS;
+}
+
+/* ─────────────────────────────────────────────
+ *  Analytics
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Fills stats with the totals of the built index.
+ *
+ * Document, alias and byte counts come from the content table.
+ */
+InvStatus inv_stats(InvIndex *idx, InvStats *stats)
+{
+    corpusStats cs;
+
+    if(idx == NULL || stats == NULL)
+        return INV_BAD_ARGUMENT;
+
+    corpus_stats(idx->table, &idx->docs, &cs);
+    stats->files = 0;
+    for(Flist *temp = idx->indexed ? idx->files : NULL; temp; temp = temp->link)
+    {
+        stats->files++;
+        if(temp == idx->indexed)
+            break;
+    }
+    stats->documents = cs.docs;
+    stats->aliases   = cs.aliases;
+    stats->terms     = cs.terms;
+    stats->postings  = cs.postings;
+    stats->tokens    = cs.tokens;
+    stats->bytes     = cs.bytes;
+    return INV_SUCCESS;
+}
+
+/**
+ * @brief  Reports the n most frequent words, most first, as full hits.
+ *
+ * Ranking and totals count aliases like search results do; ties are
+ * broken alphabetically.
+ *
+ * @return INV_SUCCESS, INV_NOT_FOUND if the index is empty,
+ *         INV_BAD_ARGUMENT for n == 0, INV_FAILURE on malloc failure.
+ */
+InvStatus inv_top_terms(InvIndex *idx, unsigned int n, InvTermRank by, InvHitFn fn, void *ctx)
+{
+    if(idx == NULL || fn == NULL || n == 0
+       || (by != INV_TERMS_BY_TOTAL && by != INV_TERMS_BY_FILES))
+        return INV_BAD_ARGUMENT;
+
+    emitCtx e = { fn, ctx, &idx->docs, NULL, 0, 0 };
+    return emit_done(&e, top_terms(idx->table, &idx->docs,
+                                   by == INV_TERMS_BY_TOTAL ? RANK_TOTAL : RANK_FILES,
+                                   n, emit_hit, &e));
+}
+
+/* ── Adapts top_docs results to InvDocFn ── */
+typedef struct
+{
+    InvDocFn  fn;
+    void     *ctx;
+} docEmitCtx;
+
+static int emit_doc(const docEntry *doc, void *arg)
+{
+    docEmitCtx *e = arg;
+    InvDocStats ds = { doc->file_name, doc->ntokens, doc->nterms, doc->len, doc->naliases };
+    return e->fn(&ds, e->ctx);
+}
+
+/**
+ * @brief  Reports the n largest indexed documents by distinct terms or by
+ *         tokens, largest first. The counts were taken while indexing.
+ *
+ * @return INV_SUCCESS, INV_NOT_FOUND if no document has been indexed,
+ *         INV_BAD_ARGUMENT for n == 0, INV_FAILURE on malloc failure.
+ */
+InvStatus inv_top_docs(InvIndex *idx, unsigned int n, InvDocRank by, InvDocFn fn, void *ctx)
+{
+    if(idx == NULL || fn == NULL || n == 0
+       || (by != INV_DOCS_BY_TERMS && by != INV_DOCS_BY_TOKENS))
+        return INV_BAD_ARGUMENT;
+
+    docEmitCtx e = { fn, ctx };
+    return to_inv_status(top_docs(&idx->docs, by == INV_DOCS_BY_TERMS ? RANK_TERMS : RANK_TOKENS,
+                                  n, emit_doc, &e));
+}
+
+/* ─────────────────────────────────────────────
+ *  Persistence
+ *  Tab-separated, one record per line:
+ *    INVSEARCH 3
+ *    F <file>                          (indexed files, in order)
+ *    D <hash> <size> <tokens> <terms> <file> <alias>...
+ *                                      (content keys, see dedup_utils.c)
+ *    W <word> <file> <count> ...       (words, in bucket chain order)
+ *  Tokens never contain whitespace, so tabs are unambiguous.
+ * ───────────────────────────────────────────── */
+
+/**
+ * @brief  Writes the indexed files and the full hash table to path.
+ *
+ * Files added but not yet built are not saved.
+ */
+InvStatus inv_save(InvIndex *idx, const char *path)
+{
+    if(idx == NULL || path == NULL)
+        return INV_BAD_ARGUMENT;
+
+    FILE *fp = fopen(path, "w");
+    if(fp == NULL)
+        return INV_FAILURE;
+
+    fprintf(fp, "%s\n", INV_SAVE_MAGIC);
+    for(Flist *temp = idx->indexed ? idx->files : NULL; temp; temp = temp->link)
+    {
+        fprintf(fp, "F\t%s\n", temp->file_name);
+        if(temp == idx->indexed)
+            break;
+    }
+
+    /* D <hash> <size> <tokens> <terms> <file> <alias>... : content keys and aliases */
+    for(u_int i = 0; i < idx->docs.ndocs; i++)
+    {
+        docEntry *d = &idx->docs.docs[i];
+        fprintf(fp, "D\t%016llx\t%zu\t%u\t%u\t%s", (unsigned long long)d->hash, d->len,
+                d->ntokens, d->nterms, d->file_name);
+        for(Flist *alias = d->aliases; alias; alias = alias->link)
+            fprintf(fp, "\t%s", alias->file_name);
+        fputc('\n', fp);
+    }
+
+    for(int i = 0; i < 27; i++)
+    {
+        for(mNode *mTemp = idx->table[i].link; mTemp; mTemp = mTemp->mLink)
+        {
+            fprintf(fp, "W\t%s", mTemp->word);
+            for(sNode *sTemp = mTemp->sLink; sTemp; sTemp = sTemp->subLink)
+                fprintf(fp, "\t%s\t%u", sTemp->file_name, sTemp->wordcount);
+            fputc('\n', fp);
+        }
+    }
+
+    if(ferror(fp))
+    {
+        fclose(fp);
+        return INV_FAILURE;
+    }
+    return fclose(fp) == 0 ? INV_SUCCESS : INV_FAILURE;
+}
+
+/**
+ * @brief  Dumps every word of the index to path for other tools.
+ *
+ * Unlike inv_save the output is not meant to be loaded back. Formatting
+ * runs on several threads and the file is written in large blocks (see
+ * export_database.c); results list aliases like search does.
+ */
+InvStatus inv_export(InvIndex *idx, const char *path, InvExportFormat fmt)
+{
+    ExportFormat ef;
+
+    if(idx == NULL || path == NULL)
+        return INV_BAD_ARGUMENT;
+    switch(fmt)
+    {
+        case INV_EXPORT_TABLE: ef = EXPORT_TABLE; break;
+        case INV_EXPORT_TSV:   ef = EXPORT_TSV;   break;
+        case INV_EXPORT_JSONL: ef = EXPORT_JSONL; break;
+        default:               return INV_BAD_ARGUMENT;
+    }
+    return to_inv_status(export_database(idx->table, &idx->docs, ef, path));
+}
+
+/**
+ * @brief  Parses one "W" record (tab-separated fields after the tag) into
+ *         a new mNode appended to its bucket.
+ */
+static Status load_word(InvIndex *idx, char *fields)
+{
+    char  *save = NULL;
+    char  *word = strtok_r(fields, "\t", &save);
+    if(word == NULL)
+        return FAILURE;
+
+    /* The node is in its bucket from here on, so inv_clear frees it on
+     * any later failure */
+    mNode *node = bucket_append(&idx->table[bucket_index(word)], word, hash_word(word), strlen(word));
+    if(node == NULL)
+        return FAILURE;
+
+    sNode **link = &node->sLink;
+    char   *file;
+    while((file = strtok_r(NULL, "\t", &save)) != NULL)
+    {
+        char *count = strtok_r(NULL, "\t", &save);
+        if(count == NULL)
+            return FAILURE;
+
+        sNode *sub = calloc(1, sizeof(sNode));
+        if(sub == NULL)
+            return FAILURE;
+        *link = sub;
+        link  = &sub->subLink;
+        node->sTail = sub;
+
+        sub->file_name = strdup(file);
+        sub->wordcount = strtoul(count, NULL, 10);
+        if(sub->file_name == NULL)
+            return FAILURE;
+        (node->filecount)++;
+    }
+    return node->filecount ? SUCCESS : FAILURE;
+}
+
+/**
+ * @brief  Parses one "D" record: a document's content key, its token and
+ *         term counts, then its name and the names of its aliases.
+ */
+static Status load_doc(InvIndex *idx, char *fields)
+{
+    char *save = NULL, *end;
+    char *hash = strtok_r(fields, "\t", &save);
+    char *len  = strtok_r(NULL, "\t", &save);
+    if(hash == NULL || len == NULL)
+        return FAILURE;
+
+    uint64_t h = strtoull(hash, &end, 16);
+    if(*end != '\0')
+        return FAILURE;
+    size_t n = strtoull(len, &end, 10);
+    if(*end != '\0')
+        return FAILURE;
+
+    char *tokens = strtok_r(NULL, "\t", &save);
+    char *terms  = strtok_r(NULL, "\t", &save);
+    if(tokens == NULL || terms == NULL)
+        return FAILURE;
+    u_int ntokens = strtoul(tokens, &end, 10);
+    if(*end != '\0')
+        return FAILURE;
+    u_int nterms = strtoul(terms, &end, 10);
+    if(*end != '\0')
+        return FAILURE;
+
+    char *file = strtok_r(NULL, "\t", &save);
+    if(file == NULL)
+        return FAILURE;
+
+    /* The first name is the indexed copy, the rest become its aliases */
+    if(dedup_add(&idx->docs, h, n, file, ntokens, nterms) == FAILURE)
+        return FAILURE;
+    for(char *alias; (alias = strtok_r(NULL, "\t", &save)) != NULL; )
+        if(dedup_alias(&idx->docs, file, alias) == FAILURE)
+            return FAILURE;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Replaces the index contents with a file written by inv_save.
+ *
+ * @return INV_SUCCESS, INV_NO_FILE if path cannot be opened, or
+ *         INV_FAILURE on a malformed file or allocation failure (the
+ *         index is left empty).
+ */
+InvStatus inv_load(InvIndex *idx, const char *path)
+{
+    if(idx == NULL || path == NULL)
+        return INV_BAD_ARGUMENT;
+
+    FILE *fp = fopen(path, "r");
+    if(fp == NULL)
+        return INV_NO_FILE;
+
+    inv_clear(idx);
+
+    char   *line = NULL;
+    size_t  cap  = 0;
+    ssize_t len;
+    Status  ret  = SUCCESS;
+
+    /* The whole first line must be the magic, so a truncated file fails */
+    len = getline(&line, &cap, fp);
+    if(len > 0 && line[len - 1] == '\n')
+        line[--len] = '\0';
+    if(len <= 0 || strcmp(line, INV_SAVE_MAGIC) != 0)
+        ret = FAILURE;
+
+    while(ret == SUCCESS && (len = getline(&line, &cap, fp)) > 0)
+    {
+        if(line[len - 1] == '\n')
+            line[--len] = '\0';
+
+        if(strncmp(line, "F\t", 2) == 0)
+        {
+            ret = insert_at_last(&idx->files, line + 2);
+            if(ret == DUPLICATE)
+                ret = FAILURE;
+        }
+        else if(strncmp(line, "W\t", 2) == 0)
+            ret = load_word(idx, line + 2);
+        else if(strncmp(line, "D\t", 2) == 0)
+            ret = load_doc(idx, line + 2);
+        else
+            ret = FAILURE;
+    }
+    free(line);
+    fclose(fp);
+
+    if(ret != SUCCESS)
+    {
+        inv_clear(idx);
+        return INV_FAILURE;
+    }
+
+    /* Every loaded file is already indexed */
+    for(idx->indexed = idx->files; idx->indexed && idx->indexed->link; )
+        idx->indexed = idx->indexed->link;
+    return INV_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file   invsearch.h
+ * @brief  Public API of libinvsearch — the embeddable inverted index.
+ *
+ * Each InvIndex is an independent, heap-allocated index; a process may
+ * hold any number of them. The library never prints: results are handed
+ * to a caller-supplied InvHitFn, one word at a time, and every other
+ * outcome is reported through InvStatus.
+ *
+ * Typical use:
+ *
+ *     InvIndex *idx = inv_create();
+ *     inv_add_file(idx, "a.txt");
+ *     inv_build(idx);
+ *     inv_search(idx, "emb", on_hit, &my_ctx);
+ *     inv_destroy(idx);
+ *
+ * An InvIndex must not be used from two threads at once; distinct
+ * indexes may be used concurrently.
+ */
+
+#ifndef INVSEARCH_H
+#define INVSEARCH_H
+
+#include <stddef.h>
+
+#define INV_MAX_WORD       1024 /* Longest word, including the NUL      */
+#define INV_MAX_SHARDS     64   /* Upper bound for inv_build_shards     */
+#define INV_MAX_FUZZY_DIST 2    /* Upper bound for inv_search_fuzzy     */
+#define INV_MAX_INGEST_DEPTH 1024   /* Upper bound for inv_set_ingest   */
+
+/* Opaque index handle */
+typedef struct invIndex InvIndex;
+
+/* ─────────────────────────────────────────────
+ *  InvStatus — Outcome of every API call
+ * ───────────────────────────────────────────── */
+typedef enum
+{
+    INV_SUCCESS,        /* Operation completed                         */
+    INV_FAILURE,        /* Allocation or I/O error                     */
+    INV_NOT_FOUND,      /* Search matched nothing                      */
+    INV_DUPLICATE,      /* File already added to this index            */
+    INV_NOT_TXT,        /* Not a .txt, .txt.gz or .txt.zst file        */
+    INV_NO_FILE,        /* File could not be opened                    */
+    INV_EMPTY_FILE,     /* File has no content                         */
+    INV_NOT_BUILT,      /* Shards searched before inv_build_shards     */
+    INV_BAD_ARGUMENT,   /* Out-of-range shard count, distance, etc.    */
+    INV_UNSUPPORTED     /* Compression format not built into library   */
+} InvStatus;
+
+typedef enum
+{
+    INV_SHARD_BY_DOC,   /* Files dealt round-robin across shards  */
+    INV_SHARD_BY_TERM   /* Terms partitioned by hash across shards */
+} InvShardMode;
+
+typedef enum
+{
+    INV_INGEST_AUTO,    /* io_uring if the kernel allows, else threads */
+    INV_INGEST_SERIAL,  /* One document at a time                      */
+    INV_INGEST_THREADS, /* Pool of reader threads                      */
+    INV_INGEST_URING    /* Batched io_uring reads (Linux 5.15+)        */
+} InvIngestMode;
+
+typedef enum
+{
+    INV_EXPORT_TABLE,   /* Padded table, as in database.txt        */
+    INV_EXPORT_TSV,     /* "word\tfile\tcount" line per posting    */
+    INV_EXPORT_JSONL    /* One JSON object per word                */
+} InvExportFormat;
+
+typedef enum
+{
+    INV_TERMS_BY_TOTAL, /* Words with the most occurrences          */
+    INV_TERMS_BY_FILES  /* Words found in the most files            */
+} InvTermRank;
+
+typedef enum
+{
+    INV_DOCS_BY_TERMS,  /* Documents with the most distinct terms   */
+    INV_DOCS_BY_TOKENS  /* Documents with the most tokens           */
+} InvDocRank;
+
+/* ─────────────────────────────────────────────
+ *  InvPosting / InvHit — One result word
+ *  Postings follow the order files were indexed in,
+ *  except that a byte-identical copy is listed right
+ *  after the file it duplicates. All pointers are
+ *  owned by the index and are valid only for the
+ *  duration of the callback.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    const char   *file_name;
+    unsigned int  count;        /* Occurrences of the word in this file */
+} InvPosting;
+
+typedef struct
+{
+    const char       *word;
+    unsigned int      bucket;   /* Hash bucket: 0–25 = a–z, 26 = other  */
+    unsigned int      filecount;/* Entries in postings[]                */
+    unsigned int      total;    /* Occurrences across all files         */
+    unsigned int      distance; /* Edit distance (fuzzy search), else 0 */
+    const InvPosting *postings;
+} InvHit;
+
+/* Receives each result in turn; return non-zero to stop early. */
+typedef int (*InvHitFn)(const InvHit *hit, void *ctx);
+
+/* Receives each file of the index in insertion order. */
+typedef int (*InvFileFn)(const char *file_name, void *ctx);
+
+/* ─────────────────────────────────────────────
+ *  InvStats / InvDocStats — Corpus analytics
+ *  Byte-identical copies of a document are indexed
+ *  once; the copies are counted as aliases only.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    unsigned int files;     /* Built files, aliases included            */
+    unsigned int documents; /* Files with distinct content              */
+    unsigned int aliases;   /* Copies of an indexed document            */
+    unsigned int terms;     /* Distinct words                           */
+    size_t       postings;  /* (word, file) pairs                       */
+    size_t       tokens;    /* Word occurrences                         */
+    size_t       bytes;     /* Decompressed size of the documents' text */
+} InvStats;
+
+typedef struct
+{
+    const char   *file_name;
+    unsigned int  tokens;   /* Words read from the document             */
+    unsigned int  terms;    /* Distinct words among them                */
+    size_t        bytes;    /* Size of its text, decompressed           */
+    unsigned int  aliases;  /* Byte-identical copies under other names  */
+} InvDocStats;
+
+/* Receives each ranked document; return non-zero to stop early. */
+typedef int (*InvDocFn)(const InvDocStats *doc, void *ctx);
+
+/* ── Lifecycle ── */
+InvIndex *inv_create(void);
+void      inv_destroy(InvIndex *idx);
+
+/* ── Building ── */
+InvStatus inv_add_file(InvIndex *idx, const char *file_name);
+InvStatus inv_set_ingest(InvIndex *idx, InvIngestMode mode, unsigned int depth);
+InvStatus inv_build(InvIndex *idx);
+InvStatus inv_build_external(InvIndex *idx, size_t budget, const char *out_path, unsigned int *runs);
+InvStatus inv_build_shards(InvIndex *idx, unsigned int nshards, InvShardMode mode);
+
+/* ── Querying ── */
+InvStatus inv_search(InvIndex *idx, const char *prefix, InvHitFn fn, void *ctx);
+InvStatus inv_search_wildcard(InvIndex *idx, const char *pattern, InvHitFn fn, void *ctx);
+InvStatus inv_search_fuzzy(InvIndex *idx, const char *word, unsigned int max_dist, InvHitFn fn, void *ctx);
+InvStatus inv_search_shards(InvIndex *idx, const char *prefix, unsigned int topk,
+                            InvHitFn fn, void *ctx, unsigned int *nmatched);
+InvStatus inv_foreach_term(InvIndex *idx, InvHitFn fn, void *ctx);
+InvStatus inv_foreach_file(InvIndex *idx, InvFileFn fn, void *ctx);
+
+/* ── Analytics ── */
+InvStatus inv_stats(InvIndex *idx, InvStats *stats);
+InvStatus inv_top_terms(InvIndex *idx, unsigned int n, InvTermRank by, InvHitFn fn, void *ctx);
+InvStatus inv_top_docs(InvIndex *idx, unsigned int n, InvDocRank by, InvDocFn fn, void *ctx);
+
+/* ── Persistence ── */
+InvStatus inv_save(InvIndex *idx, const char *path);
+InvStatus inv_export(InvIndex *idx, const char *path, InvExportFormat fmt);
+InvStatus inv_load(InvIndex *idx, const char *path);
+
+#endif /* INVSEARCH_H */
@@ -0,0 +1,133 @@
+/**
+ * @file   ltable_utils.c
+ * @brief  Per-file term table (lTable) used while indexing a single file.
+ *
+ * An open-addressing hash table small enough to stay cache-resident.
+ * Tokens are counted here first and only the distinct terms are merged
+ * into the global index (or spilled to a run file by the external build).
+ */
+
+#include "main.h"
+
+#define LTABLE_INIT_CAP 256     /* Distinct terms before the first grow */
+
+Status ltable_init(lTable *t)
+{
+    t->nterms = 0;
+    t->cap    = LTABLE_INIT_CAP;
+    t->bytes  = 0;
+    t->terms  = malloc(t->cap * sizeof(lTerm));
+    t->slots  = calloc(2 * t->cap, sizeof(u_int));
+    if(t->terms == NULL || t->slots == NULL)
+    {
+        free(t->terms);
+        free(t->slots);
+        t->terms = NULL;                /* Leave a table ltable_free accepts */
+        t->slots = NULL;
+        t->cap   = 0;
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief  Doubles the table and re-inserts every term using its stored hash.
+ */
+static Status ltable_grow(lTable *t)
+{
+    u_int  new_cap   = t->cap * 2;
+    u_int  mask      = 2 * new_cap - 1;
+    lTerm *new_terms = realloc(t->terms, new_cap * sizeof(lTerm));
+    if(new_terms == NULL)
+        return FAILURE;
+    t->terms = new_terms;
+
+    u_int *new_slots = calloc(2 * new_cap, sizeof(u_int));
+    if(new_slots == NULL)
+        return FAILURE;
+
+    for(u_int i = 0; i < t->nterms; i++)
+    {
+        u_int pos = t->terms[i].hash & mask;
+        while(new_slots[pos])
+            pos = (pos + 1) & mask;
+        new_slots[pos] = i + 1;
+    }
+
+    free(t->slots);
+    t->slots = new_slots;
+    t->cap   = new_cap;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Counts one occurrence of word in the table.
+ *
+ * @return SUCCESS, or FAILURE if an allocation failed.
+ */
+Status ltable_add(lTable *t, const char *word)
+{
+    uint64_t h    = hash_word(word);
+    u_int    mask = 2 * t->cap - 1;
+    u_int    pos  = h & mask;
+
+    /* ── Linear probe: stop at the matching term or an empty slot ── */
+    while(t->slots[pos])
+    {
+        lTerm *term = &t->terms[t->slots[pos] - 1];
+        if(term->hash == h && strcmp(term->word, word) == 0)
+        {
+            (term->count)++;
+            return SUCCESS;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    /* ── New distinct term ── */
+    if(t->nterms == t->cap)
+    {
+        if(ltable_grow(t) == FAILURE)
+            return FAILURE;
+        return ltable_add(t, word);     /* Slot positions changed — re-probe */
+    }
+
+    lTerm *term = &t->terms[t->nterms];
+    term->word  = strdup(word);
+    if(term->word == NULL)
+        return FAILURE;
+    term->hash  = h;
+    term->count = 1;
+    t->bytes   += strlen(word) + 1;
+
+    t->slots[pos] = ++(t->nterms);
+    return SUCCESS;
+}
+
+/**
+ * @brief  Approximate heap footprint of the table, including owned words.
+ */
+size_t ltable_mem(const lTable *t)
+{
+    return t->cap * (sizeof(lTerm) + 2 * sizeof(u_int)) + t->bytes;
+}
+
+/**
+ * @brief  Empties the table for the next file, freeing any words that
+ *         were not handed over (set to NULL) by the caller.
+ */
+void ltable_reset(lTable *t)
+{
+    for(u_int i = 0; i < t->nterms; i++)
+        free(t->terms[i].word);
+    if(t->slots)
+        memset(t->slots, 0, 2 * t->cap * sizeof(u_int));
+    t->nterms = 0;
+    t->bytes  = 0;
+}
+
+void ltable_free(lTable *t)
+{
+    ltable_reset(t);
+    free(t->terms);
+    free(t->slots);
+}
@@ -2,17 +2,110 @@
  * @file   main.c
  * @brief  Entry point and interactive menu loop for the Inverted Search Engine.
  *
+ * The menu is a client of libinvsearch and uses only invsearch.h: the
+ * library never prints, so every message below is produced here from the
+ * returned InvStatus or the InvHit passed to a callback.
+ *
  * Flow:
  *   1. Validate command-line arguments (at least one .txt file required).
- *   2. Validate and load each file into the Flist.
- *   3. Initialize the 27-bucket hash table.
- *   4. Enter the menu loop — user drives all operations from here.
- *   5. On exit: auto-save, free all heap memory, and return.
+ *   2. Create an index and add each file to it.
+ *   3. Enter the menu loop — user drives all operations from here.
+ *   4. On exit: auto-save, destroy the index, and return.
  */
 
-#include "main.h"
+#include "cli.h"
+
+#define MAX_SHOWN_FUZZY 20  /* Ranked suggestions printed per fuzzy query */
+
+/* ── Per-query state for print_hit ── */
+typedef struct
+{
+    int          fuzzy;     /* Prefix each hit with its edit distance */
+    unsigned int shown;
+    unsigned int limit;     /* 0 = no limit                           */
+} hitPrinter;
+
+/**
+ * @brief  Prints one matched word with its per-file counts and total.
+ *
+ * Shared by every lookup mode so all results read the same.
+ */
+static int print_hit(const InvHit *hit, void *ctx)
+{
+    hitPrinter *p = ctx;
+
+    if(p->fuzzy)
+        printf(H_YELLOW "[Distance %u] " RESET, hit->distance);
+    printf("Found match: [" H_GREEN "%s" RESET "]\n", hit->word);
+
+    for(unsigned int i = 0; i < hit->filecount; i++)
+        printf("  -> in %s : %u times\n", hit->postings[i].file_name, hit->postings[i].count);
+
+    printf("  -> Total appearances: " H_MAGENTA "%u" RESET " Times\n\n", hit->total);
+
+    p->shown++;
+    return p->limit && p->shown >= p->limit;
+}
+
+static int print_file(const char *file_name, void *ctx)
+{
+    int *first = ctx;
+    printf("%s" BOLD_YELLOW "| %s |" RESET, *first ? "" : H_CYAN " -> " RESET, file_name);
+    *first = 0;
+    return 0;
+}
 
-Status main(int argc, char *argv[])
+static void print_list(InvIndex *idx)
+{
+    int first = 1;
+
+    printf(BG_BLUE "_____________________________\n" RESET);
+    printf("\n");
+    inv_foreach_file(idx, print_file, &first);
+    if(first)
+        printf(H_YELLOW "[Info] : List is Empty" RESET);
+    printf("\n");
+    printf(BG_BLUE "_____________________________\n" RESET);
+    printf("\n");
+}
+
+/**
+ * @brief  Adds one file to the index and reports why it was rejected, if it was.
+ * @return 1 if the file was added, 0 otherwise.
+ */
+static int report_add(InvIndex *idx, const char *file_name)
+{
+    switch(inv_add_file(idx, file_name))
+    {
+        case INV_SUCCESS:
+            printf(BOLD_GREEN "[Info] : Read And Validation of [%s] Is Successfull Completed\n" RESET, file_name);
+            return 1;
+        case INV_NOT_TXT:
+            printf(H_RED "[Info] : %s is not a .txt file\n" RESET, file_name);
+            break;
+        case INV_UNSUPPORTED:
+            printf(H_RED "[Info] : %s is compressed in a format this build cannot read\n" RESET, file_name);
+            break;
+        case INV_EMPTY_FILE:
+            printf(H_RED "%s file is empty\n" RESET, file_name);
+            break;
+        case INV_DUPLICATE:
+            printf(H_YELLOW "[Info] : %s's Duplicate Found\n" RESET, file_name);
+            break;
+        default:
+            break;
+    }
+    printf(BOLD_RED "[Info] : Read And Validation of [%s] Is Failed\n" RESET, file_name);
+    return 0;
+}
+
+static void discard_line(void)
+{
+    int c;
+    while((c = getchar()) != '\n' && c != EOF);
+}
+
+int main(int argc, char *argv[])
 {
     int choice;
 
@@ -20,27 +113,21 @@ Status main(int argc, char *argv[])
     if(argc < 2)
     {
         printf(H_RED "[Info] : Not Enough Arguments\n" RESET);
-        printf(H_YELLOW "[Usage] : %s <file.txt> [<file1.txt> ...]\n" RESET, argv[0]);
+        printf(H_YELLOW "[Usage] : %s <file.txt[.gz]> [<file1.txt[.gz]> ...]\n" RESET, argv[0]);
         return 1;
     }
 
-    Flist *head = NULL;
-
-    /* ── Validate and load each file argument into the Flist ── */
-    argc -= 1;  /* Subtract argv[0] (program name) */
-    for(int i = 1; i <= argc; i++)
+    InvIndex *idx = inv_create();
+    if(idx == NULL)
     {
-        int ret = read_and_validation(argv, i, &head);
-        if(ret == SUCCESS)
-            printf(BOLD_GREEN "[Info] : Read And Validation of [%s] Is Successfull Completed\n" RESET, argv[i]);
-        else
-            printf(BOLD_RED "[Info] : Read And Validation of [%s] Is Failed\n" RESET, argv[i]);
+        printf(BOLD_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+        return 1;
     }
-    print_list(head);
 
-    /* ── Initialize the hash table ── */
-    hash_T hash_t[27];
-    initialize_hashTable(hash_t);
+    /* ── Validate and add each file argument to the index ── */
+    for(int i = 1; i < argc; i++)
+        report_add(idx, argv[i]);
+    print_list(idx);
 
     /* ── Menu loop ── */
     while(1)
@@ -51,19 +138,26 @@ Status main(int argc, char *argv[])
             BOLD_CYAN "3. Search Database"  RESET,
             BOLD_CYAN "4. Update Database"  RESET,
             BOLD_CYAN "5. Save Database"    RESET,
-            BOLD_RED  "6. Exit"             RESET
+            BOLD_RED  "6. Exit"             RESET,
+            BOLD_CYAN "7. Build Database On Disk (memory-bounded)" RESET,
+            BOLD_CYAN "8. Build Sharded Database" RESET,
+            BOLD_CYAN "9. Search Sharded Database" RESET,
+            BOLD_CYAN "10. Wildcard / Substring Search" RESET,
+            BOLD_CYAN "11. Fuzzy Search (typo-tolerant)" RESET,
+            BOLD_CYAN "12. Load Database" RESET,
+            BOLD_CYAN "13. Benchmark Ingestion" RESET,
+            BOLD_CYAN "14. Export Database (TSV / JSONL)" RESET,
+            BOLD_CYAN "15. Corpus Statistics (top words / documents)" RESET
         };
-        for(int i = 0; i < 6; i++) { printf("%s\n", menu[i]); }
+        for(int i = 0; i < (int)(sizeof(menu) / sizeof(menu[0])); i++) { printf("%s\n", menu[i]); }
         printf(GREEN "Enter the Choice : " RESET);
 
         // scanf returns the number of items successfully read. 
         // If it returns anything other than 1, the user typed letters/symbols.
         if (scanf("%d", &choice) != 1) 
         {
-            // Clear the invalid input from the buffer character by character
-            // until we hit the newline (Enter key)
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
+            // Clear the invalid input from the buffer until we hit the newline (Enter key)
+            discard_line();
             
             printf(H_RED "Invalid input! Please enter a number.\n" RESET);
             continue; // Skip the rest of the loop and show the menu again
@@ -74,7 +168,7 @@ Status main(int argc, char *argv[])
             /* ── 1. Index all files in the Flist ── */
             case 1:
             {
-                if(create_database(hash_t, head) == SUCCESS)
+                if(inv_build(idx) == INV_SUCCESS)
                     printf(BOLD_BLUE "[Info] : Database has been created / Updated Successfully\n" RESET);
                 else
                     printf(BOLD_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
@@ -85,7 +179,7 @@ Status main(int argc, char *argv[])
             /* ── 2. Print the full index as a colored table ── */
             case 2:
             {
-                display_database(hash_t);
+                display_database(idx);
                 printf("\n");
                 break;
             }
@@ -93,66 +187,256 @@ Status main(int argc, char *argv[])
             /* ── 3. Look up a specific word ── */
             case 3:
             {
-                char keyword[20];
+                char keyword[INV_MAX_WORD];
                 printf(H_CYAN "Enter the word you want to search : " RESET);
-                scanf("%s", keyword);
+                scanf("%1023s", keyword);
 
-                if(search_database(hash_t, keyword) == DATA_NOT_FOUND)
+                hitPrinter printer = { 0, 0, 0 };
+                if(inv_search(idx, keyword, print_hit, &printer) == INV_NOT_FOUND)
                     printf(H_MAGENTA "[Info] : %s is not found in the database\n" RESET, keyword);
 
                 printf("\n");
                 break;
             }
 
-            /* ── 4. Add new files to the existing index ── */
+            /* ── 4. Add new files and index only those ── */
             case 4:
             {
-                unsigned int fileCount;
+                unsigned int fileCount, added = 0;
                 printf(BLUE "Enter how many files you want to update to the database : " RESET);
-                scanf("%u", &fileCount);
+                if(scanf("%u", &fileCount) != 1)
+                {
+                    discard_line();
+                    printf(H_RED "Invalid input! Please enter a number.\n" RESET);
+                    break;
+                }
 
-                /* Collect filenames into a VLA of strdup'd strings */
-                char *fileHolder[fileCount];
-                for(int i = 0; i < fileCount; i++)
+                for(unsigned int i = 0; i < fileCount; i++)
                 {
-                    char tempFileName[20];
+                    char tempFileName[INV_MAX_WORD];
                     printf(H_YELLOW "Enter the File Name : " RESET);
-                    scanf("%s", tempFileName);
-                    fileHolder[i] = strdup(tempFileName);
+                    scanf("%1023s", tempFileName);
+                    added += report_add(idx, tempFileName);
                 }
 
-                printf(H_GREEN "[Info] : Files have been loaded successfully\n" RESET);
-                for(int i = 0; i < fileCount; i++)
-                    printf("%s\n", fileHolder[i]);
-
-                /* Pass &head so the Flist updates are visible after return */
-                update_database(hash_t, &head, fileHolder, fileCount);
-
-                /* Free only the strdup'd strings — fileHolder itself is on the stack */
-                for(int i = 0; i < fileCount; i++)
-                    free(fileHolder[i]);
-
+                /* inv_build only reads files not indexed yet */
+                if(added == 0)
+                    printf(H_BLUE "[Info] : No new valid files were added to index\n" RESET);
+                else if(inv_build(idx) == INV_SUCCESS)
+                    printf(BOLD_BLUE "[Info] : Database has been created / Updated Successfully\n" RESET);
+                else
+                    printf(BOLD_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
                 break;
             }
 
-            /* ── 5. Export the index to database.txt ── */
+            /* ── 5. Export the index to DB_FILE, and reloadably to IDX_FILE ── */
             case 5:
             {
-                if(save_database(hash_t) == SUCCESS)
+                if(save_database(idx) == INV_SUCCESS && inv_save(idx, IDX_FILE) == INV_SUCCESS)
                     printf(H_GREEN "[Info] : Database has been saved Successfully\n" RESET);
                 else
                     printf(H_RED "[Error] : Error Occured While Saving the database\n" RESET);
                 break;
             }
 
-            /* ── 6. Auto-save, free all memory, and exit ── */
+            /* ── 6. Auto-save, destroy the index, and exit ── */
             case 6:
             {
-                save_database(hash_t);
-                free_hash_table(hash_t);
-                free_list(&head);
+                save_database(idx);
+                inv_save(idx, IDX_FILE);
+                inv_destroy(idx);
                 printf(H_CYAN "Program Exited Successfully\n" RESET);
-                return SUCCESS;
+                return 0;
+            }
+
+            /* ── 7. Spill-to-disk build of all files into EXT_DB_FILE ── */
+            case 7:
+            {
+                unsigned long budget_kb;
+                printf(BLUE "Enter the RAM budget in KB : " RESET);
+                if(scanf("%lu", &budget_kb) != 1)
+                {
+                    discard_line();
+                    printf(H_RED "Invalid input! Please enter a number.\n" RESET);
+                    break;
+                }
+
+                unsigned int runs = 0;
+                if(inv_build_external(idx, budget_kb * 1024, EXT_DB_FILE, &runs) == INV_SUCCESS)
+                    printf(BOLD_BLUE "[Info] : Database has been built on disk in %s (%u run(s) spilled)\n" RESET,
+                           EXT_DB_FILE, runs);
+                else
+                    printf(BOLD_RED "[Error] : Error Occured While Building the database on disk\n" RESET);
+                printf("\n");
+                break;
+            }
+
+            /* ── 8. Build N shards in parallel ── */
+            case 8:
+            {
+                unsigned int nshards, mode;
+                printf(BLUE "Enter the number of shards (1-%d) : " RESET, INV_MAX_SHARDS);
+                if(scanf("%u", &nshards) != 1 || nshards == 0 || nshards > INV_MAX_SHARDS)
+                {
+                    discard_line();
+                    printf(H_RED "Invalid shard count\n" RESET);
+                    break;
+                }
+                printf(BLUE "Partition by (1) Document or (2) Term : " RESET);
+                if(scanf("%u", &mode) != 1 || (mode != 1 && mode != 2))
+                {
+                    discard_line();
+                    printf(H_RED "Invalid partition mode\n" RESET);
+                    break;
+                }
+
+                if(inv_build_shards(idx, nshards, mode == 1 ? INV_SHARD_BY_DOC : INV_SHARD_BY_TERM) == INV_SUCCESS)
+                    printf(BOLD_BLUE "[Info] : %u shard(s) built successfully\n" RESET, nshards);
+                else
+                    printf(BOLD_RED "[Error] : An Error has Occured while building the shards\n" RESET);
+                printf("\n");
+                break;
+            }
+
+            /* ── 9. Scatter-gather prefix search, optionally top-k ── */
+            case 9:
+            {
+                char keyword[INV_MAX_WORD];
+                unsigned int topk, nmatched = 0;
+                printf(H_CYAN "Enter the word you want to search : " RESET);
+                scanf("%1023s", keyword);
+                printf(H_CYAN "Show top how many words (0 = all) : " RESET);
+                if(scanf("%u", &topk) != 1)
+                {
+                    discard_line();
+                    topk = 0;
+                }
+
+                hitPrinter printer = { 0, 0, 0 };
+                InvStatus  ret     = inv_search_shards(idx, keyword, topk, print_hit, &printer, &nmatched);
+                if(ret == INV_NOT_BUILT)
+                    printf(H_YELLOW "[Info] : Build the sharded database first (option 8)\n" RESET);
+                else if(ret == INV_NOT_FOUND)
+                    printf(H_MAGENTA "[Info] : %s is not found in the database\n" RESET, keyword);
+                else if(ret == INV_SUCCESS && printer.shown < nmatched)
+                    printf(H_CYAN "[Info] : Showing top %u of %u matching words\n" RESET, printer.shown, nmatched);
+                else if(ret == INV_FAILURE)
+                    printf(H_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+
+                printf("\n");
+                break;
+            }
+
+            /* ── 10. Trigram-accelerated wildcard / substring lookup ── */
+            case 10:
+            {
+                char pattern[INV_MAX_WORD];
+                printf(H_CYAN "Enter the pattern (* = any, ? = one, plain = substring) : " RESET);
+                scanf("%1023s", pattern);
+
+                hitPrinter printer = { 0, 0, 0 };
+                InvStatus  ret     = inv_search_wildcard(idx, pattern, print_hit, &printer);
+                if(ret == INV_NOT_FOUND)
+                    printf(H_MAGENTA "[Info] : Nothing matches %s in the database\n" RESET, pattern);
+                else if(ret == INV_SUCCESS)
+                    printf(H_CYAN "[Info] : %u match(es)\n" RESET, printer.shown);
+                else if(ret == INV_FAILURE)
+                    printf(H_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+
+                printf("\n");
+                break;
+            }
+
+            /* ── 11. Closest words within a bounded edit distance ── */
+            case 11:
+            {
+                char keyword[INV_MAX_WORD];
+                unsigned int max_dist;
+                printf(H_CYAN "Enter the word you want to search : " RESET);
+                scanf("%1023s", keyword);
+                printf(H_CYAN "Enter the maximum edit distance (1-%d) : " RESET, INV_MAX_FUZZY_DIST);
+                if(scanf("%u", &max_dist) != 1 || max_dist == 0 || max_dist > INV_MAX_FUZZY_DIST)
+                {
+                    discard_line();
+                    printf(H_RED "Invalid edit distance\n" RESET);
+                    break;
+                }
+
+                hitPrinter printer = { 1, 0, MAX_SHOWN_FUZZY };
+                InvStatus  ret     = inv_search_fuzzy(idx, keyword, max_dist, print_hit, &printer);
+                if(ret == INV_NOT_FOUND)
+                    printf(H_MAGENTA "[Info] : Nothing close to %s in the database\n" RESET, keyword);
+                else if(ret == INV_SUCCESS && printer.shown == MAX_SHOWN_FUZZY)
+                    printf(H_CYAN "[Info] : Best %u suggestions shown\n" RESET, printer.shown);
+                else if(ret == INV_FAILURE)
+                    printf(H_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+
+                printf("\n");
+                break;
+            }
+
+            /* ── 12. Replace the index with the one saved in IDX_FILE ── */
+            case 12:
+            {
+                InvStatus ret = inv_load(idx, IDX_FILE);
+                if(ret == INV_SUCCESS)
+                {
+                    printf(H_GREEN "[Info] : Database has been loaded from %s\n" RESET, IDX_FILE);
+                    print_list(idx);
+                }
+                else if(ret == INV_NO_FILE)
+                    printf(H_YELLOW "[Info] : No saved database found (%s)\n" RESET, IDX_FILE);
+                else
+                    printf(H_RED "[Error] : %s is corrupt or could not be read\n" RESET, IDX_FILE);
+
+                printf("\n");
+                break;
+            }
+
+            /* ── 13. Time inv_build with every document reader ── */
+            case 13:
+            {
+                benchmark_ingest(idx);
+                printf("\n");
+                break;
+            }
+
+            /* ── 14. Dump the index for other tools ── */
+            case 14:
+            {
+                unsigned int format;
+                printf(BLUE "Export as (1) TSV or (2) JSON Lines : " RESET);
+                if(scanf("%u", &format) != 1 || (format != 1 && format != 2))
+                {
+                    discard_line();
+                    printf(H_RED "Invalid export format\n" RESET);
+                    break;
+                }
+
+                const char *path = (format == 1) ? TSV_FILE : JSONL_FILE;
+                if(inv_export(idx, path, format == 1 ? INV_EXPORT_TSV : INV_EXPORT_JSONL) == INV_SUCCESS)
+                    printf(H_GREEN "[Info] : Database has been exported to %s\n" RESET, path);
+                else
+                    printf(H_RED "[Error] : Error Occured While Exporting the database\n" RESET);
+                printf("\n");
+                break;
+            }
+
+            /* ── 15. Totals and top-N rankings without a full dump ── */
+            case 15:
+            {
+                unsigned int n;
+                printf(H_CYAN "Show top how many words / documents : " RESET);
+                if(scanf("%u", &n) != 1 || n == 0)
+                {
+                    discard_line();
+                    printf(H_RED "Invalid count\n" RESET);
+                    break;
+                }
+
+                show_stats(idx, n);
+                printf("\n");
+                break;
             }
 
             default:
@@ -162,5 +446,5 @@ Status main(int argc, char *argv[])
         }
     }
 
-    return FAILURE;
+    return 1;
 }
\ No newline at end of file
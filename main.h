@@ -1,9 +1,10 @@
 /**
  * @file   main.h
- * @brief  Central header for the Inverted Search Engine.
+ * @brief  Central (internal) header for the Inverted Search Engine library.
  *
  * Defines all shared types, data structures, status codes, and function
- * declarations used across the project's translation units.
+ * declarations used across libinvsearch's translation units. Clients of
+ * the library — including the interactive menu — use invsearch.h only.
  */
 
 #ifndef MAIN_H
@@ -13,8 +14,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stdint.h>
 
-#include "color.h"
+#include "invsearch.h"
 
 /* ─────────────────────────────────────────────
  *  Type Aliases
@@ -22,6 +24,18 @@
 
 typedef unsigned int u_int;
 
+/* Longest token read from a file, including the terminating NUL */
+#define WORD_BUF_SIZE INV_MAX_WORD
+
+#define EXT_MIN_BUDGET  (64 * 1024)     /* Smallest accepted RAM budget (bytes) */
+
+#define SHARD_MAX INV_MAX_SHARDS        /* Upper bound on shards (one thread each) */
+
+#define FUZZY_MAX_DIST INV_MAX_FUZZY_DIST   /* Largest edit distance fuzzy search accepts */
+
+#define INGEST_DEPTH 64                 /* Default documents in flight while indexing */
+#define INGEST_DEPTH_MAX INV_MAX_INGEST_DEPTH
+
 /* ─────────────────────────────────────────────
  *  Status Codes
  *  Returned by most functions to signal outcome.
@@ -32,9 +46,66 @@ typedef enum
     FAILURE,        /* Generic failure (malloc, fopen, etc.)      */
     LIST_EMPTY,     /* Flist is NULL when a traversal was needed  */
     DUPLICATE,      /* File already exists in the Flist           */
-    DATA_NOT_FOUND  /* Word not present in the hash table         */
+    DATA_NOT_FOUND, /* Word not present in the hash table         */
+    NOT_TXT_FILE,   /* Filename has no ".txt" extension           */
+    FILE_NOT_OPEN,  /* File does not exist or is not readable     */
+    FILE_EMPTY,     /* File has no content to index               */
+    UNSUPPORTED     /* Compression format not built in            */
 } Status;
 
+/* ─────────────────────────────────────────────
+ *  DocFormat — On-disk encoding of a document,
+ *  chosen from its file name (stream_utils.c).
+ * ───────────────────────────────────────────── */
+typedef enum
+{
+    DOC_UNKNOWN,    /* Not a .txt document                    */
+    DOC_PLAIN,      /* name.txt                               */
+    DOC_GZIP,       /* name.txt.gz                            */
+    DOC_ZSTD        /* name.txt.zst (needs HAVE_ZSTD)         */
+} DocFormat;
+
+/* ─────────────────────────────────────────────
+ *  IngestMode — How documents are read while
+ *  indexing (ingest_utils.c).
+ * ───────────────────────────────────────────── */
+typedef enum
+{
+    INGEST_AUTO,    /* io_uring if available, else threads    */
+    INGEST_SERIAL,  /* One document at a time, one opened ahead */
+    INGEST_THREADS, /* Pool of blocking reader threads        */
+    INGEST_URING    /* Linked open/read/close on an io_uring  */
+} IngestMode;
+
+/* ─────────────────────────────────────────────
+ *  ExportFormat — Layout written by export_database
+ * ───────────────────────────────────────────── */
+typedef enum
+{
+    EXPORT_TABLE,   /* database.txt-style padded table        */
+    EXPORT_TSV,     /* word<TAB>file<TAB>count per posting    */
+    EXPORT_JSONL    /* One JSON object per word               */
+} ExportFormat;
+
+/* ─────────────────────────────────────────────
+ *  TermRank / DocRank — Orderings of the top-N
+ *  queries (analytics_database.c)
+ * ───────────────────────────────────────────── */
+typedef enum
+{
+    RANK_TOTAL,     /* Words by occurrences across all files  */
+    RANK_FILES      /* Words by number of files               */
+} TermRank;
+
+typedef enum
+{
+    RANK_TERMS,     /* Documents by distinct terms            */
+    RANK_TOKENS     /* Documents by tokens                    */
+} DocRank;
+
+/* Batched document reader (opaque, see ingest_utils.c) */
+typedef struct ingestReader ingestReader;
+
 /* ─────────────────────────────────────────────
  *  Flist — File List Node
  *  A singly-linked list of filenames that have
@@ -58,64 +129,328 @@ typedef struct subNode
     struct subNode *subLink;    /* Next file this word appears in         */
 } sNode;
 
+#define MNODE_INLINE 24                 /* Words shorter than this live inside their mNode */
+
 /* ─────────────────────────────────────────────
  *  mNode — Main Node
  *  One mNode per unique word in the index.
  *  Chains horizontally across hash bucket collisions,
  *  and vertically into sNode sub-nodes.
+ *  Exactly one 64-byte cache line: a word shorter than
+ *  MNODE_INLINE is stored in inl[], so reading it
+ *  touches no other memory.
  * ───────────────────────────────────────────── */
 typedef struct mainNode
 {
-    u_int           filecount;  /* Number of files this word appears in   */
-    char            *word;      /* Heap-allocated word string (via strdup)*/
-    sNode          *sLink;      /* Head of this word's sNode chain        */
     struct mainNode *mLink;     /* Next word in the same hash bucket      */
+    sNode           *sLink;     /* Head of this word's sNode chain        */
+    sNode           *sTail;     /* Last sNode, where new files are added  */
+    char            *word;      /* inl, or the bucket's long-word storage */
+    u_int            filecount; /* Number of files this word appears in   */
+    u_int            len;       /* strlen(word)                           */
+    char             inl[MNODE_INLINE];
 } mNode;
 
+_Static_assert(sizeof(mNode) == 64, "mNode must fill one cache line");
+
+/* ─────────────────────────────────────────────
+ *  dictSlot / dictSlab — Storage behind a bucket
+ *  slots[] is an open-addressing directory over the
+ *  bucket's words; a probe compares the stored hash
+ *  before touching the mNode. Slabs are never moved,
+ *  so mNode pointers stay valid until the table is freed.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    uint64_t  hash;     /* hash_word(word); node NULL = empty slot */
+    mNode    *node;
+} dictSlot;
+
+typedef struct dictSlab
+{
+    char            *data;      /* mNodes (cache-line aligned) or word bytes */
+    size_t           used;      /* Bytes handed out                          */
+    size_t           cap;
+    struct dictSlab *next;      /* Older slab                                */
+} dictSlab;
+
 /* ─────────────────────────────────────────────
  *  hash_T — Hash Table Bucket
  *  The hash table is a fixed array of 27 of these:
  *    - Index 0–25  → words starting with a–z (case-insensitive)
  *    - Index 26    → words starting with non-alphabetic characters
+ *  The chain keeps words in first-seen order; its mNodes
+ *  are carved from the bucket's own slabs in that order,
+ *  so walking it reads memory front to back.
  * ───────────────────────────────────────────── */
 typedef struct hashT
 {
-    u_int  index; /* Bucket index (0–26)               */
-    mNode *link;  /* Head of this bucket's mNode chain */
+    u_int     index;    /* Bucket index (0–26)                   */
+    mNode    *link;     /* Head of this bucket's mNode chain     */
+    mNode    *tail;     /* Last mNode of the chain               */
+    dictSlot *slots;    /* Directory, nslots entries             */
+    u_int     nslots;   /* Power of two, 0 before the first word */
+    u_int     nwords;   /* mNodes in the chain                   */
+    dictSlab *nodes;    /* Slabs of mNodes, newest first         */
+    dictSlab *bytes;    /* Slabs of long words, newest first     */
 } hash_T;
 
+/* ─────────────────────────────────────────────
+ *  shard_T / shardIndex — Partitioned index
+ *  Each shard is a self-contained 27-bucket table,
+ *  built and searched on its own thread.
+ * ───────────────────────────────────────────── */
+typedef enum
+{
+    SHARD_BY_DOC,   /* Files dealt round-robin across shards   */
+    SHARD_BY_TERM   /* Terms split by hash_word() % nshards    */
+} ShardMode;
+
+typedef struct shard
+{
+    hash_T  table[27];  /* This shard's hash table                  */
+    Flist  *files;      /* Files owned by the shard (SHARD_BY_DOC)  */
+} shard_T;
+
+typedef struct shardIndex
+{
+    shard_T   *shards;  /* Array of nshards shards      */
+    u_int      nshards; /* 0 until build_shards runs    */
+    ShardMode  mode;
+} shardIndex;
+
+/* ─────────────────────────────────────────────
+ *  triPost / triIndex — Trigram index over the dictionary
+ *  Maps every 3-byte window of every (lower-cased, boundary-
+ *  padded) word to the sorted ids of the words containing it.
+ *  A word id is its position in words[].
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    uint32_t  key;      /* Packed trigram, 0 = empty slot   */
+    u_int    *ids;      /* Ascending word ids               */
+    u_int     nids;
+    u_int     cap;
+} triPost;
+
+typedef struct
+{
+    mNode   **words;    /* Snapshot of every mNode at build time   */
+    u_int     nwords;
+    triPost  *posts;    /* Open-addressing table of posting lists  */
+    u_int     nslots;   /* Power of two                            */
+    u_int     nposts;   /* Distinct trigrams                       */
+    int       stale;    /* Non-zero once the hash table has changed */
+} triIndex;
+
+/* ─────────────────────────────────────────────
+ *  fzPost / fzIndex — Deletion-neighbourhood index
+ *  Maps the hash of every string reachable by deleting
+ *  up to FUZZY_MAX_DIST characters from a word's prefix
+ *  to the ids of those words (positions in words[]).
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    uint64_t  key;      /* hash_word(variant), 0 = empty slot */
+    u_int    *ids;      /* Ascending word ids                 */
+    u_int     nids;
+    u_int     cap;
+} fzPost;
+
+typedef struct
+{
+    mNode   **words;    /* Snapshot of every mNode at build time    */
+    u_int     nwords;
+    fzPost   *posts;    /* Open-addressing table of posting lists   */
+    u_int     nslots;   /* Power of two                             */
+    u_int     nposts;   /* Distinct deletion variants               */
+    int       stale;    /* Non-zero once the hash table has changed */
+} fzIndex;
+
+/* ─────────────────────────────────────────────
+ *  lTerm / lTable — Per-file term counts
+ *  terms[] keeps distinct words in first-seen order (so a flush
+ *  preserves the original chain order); slots[] is the open-addressing
+ *  index into terms[], storing (position + 1) with 0 meaning empty.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    char     *word;     /* strdup'd; the consumer may take ownership      */
+    uint64_t  hash;     /* hash_word(word), kept to avoid rehashing       */
+    u_int     count;    /* Occurrences of word in the current file        */
+} lTerm;
+
+typedef struct
+{
+    lTerm  *terms;      /* Distinct terms in first-seen order      */
+    u_int   nterms;     /* Number of used entries in terms[]        */
+    u_int   cap;        /* Capacity of terms[]                      */
+    u_int  *slots;      /* Probe table, length 2 × cap (power of 2) */
+    size_t  bytes;      /* Bytes held by the owned word strings     */
+} lTable;
+
+/* ─────────────────────────────────────────────
+ *  docEntry / docTable — Indexed documents by content
+ *  Byte-identical documents are indexed once: later
+ *  copies become aliases of the first, and results
+ *  list them next to it. docs[] is dense; both probe
+ *  tables store (position + 1), 0 meaning empty.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    uint64_t  hash;       /* hash_bytes() of the document's text   */
+    size_t    len;        /* Size of that text (decompressed)      */
+    char     *file_name;  /* The copy that was indexed (strdup'd)  */
+    Flist    *aliases;    /* Other copies, in the order they came  */
+    Flist    *last;       /* Tail of aliases                       */
+    u_int     naliases;
+    u_int     ntokens;    /* Tokens read from the document         */
+    u_int     nterms;     /* Distinct terms among them             */
+} docEntry;
+
+typedef struct
+{
+    docEntry *docs;       /* Indexed documents in index order        */
+    u_int     ndocs;
+    u_int     cap;
+    u_int    *by_content; /* Probe table keyed on (hash, len)        */
+    u_int    *by_name;    /* Probe table keyed on hash_word(name)    */
+    u_int     naliases;   /* Aliases across all documents            */
+} docTable;
+
+/* ─────────────────────────────────────────────
+ *  corpusStats — Totals of one index
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    u_int   terms;      /* Distinct words (mNodes)                */
+    size_t  postings;   /* (word, file) pairs (sNodes)            */
+    size_t  tokens;     /* Occurrences across all postings        */
+    u_int   docs;       /* Documents in the docTable              */
+    u_int   aliases;    /* Copies recorded as aliases             */
+    size_t  bytes;      /* Size of the documents in the docTable  */
+} corpusStats;
+
+/* ─────────────────────────────────────────────
+ *  invIndex — The library's opaque index handle
+ *  Everything one index needs lives here, so any
+ *  number of them can coexist in one process.
+ * ───────────────────────────────────────────── */
+struct invIndex
+{
+    hash_T      table[27];  /* The 27-bucket hash table                   */
+    Flist      *files;      /* Every accepted file, in insertion order    */
+    Flist      *indexed;    /* Last file already in table (NULL = none)   */
+    triIndex    tri;        /* Wildcard index, rebuilt lazily when stale  */
+    fzIndex     fuzzy;      /* Fuzzy index, rebuilt lazily when stale     */
+    shardIndex  shards;     /* Optional sharded copy of the index         */
+    docTable    docs;       /* Content hashes and aliases of indexed files */
+    IngestMode  ingest;     /* Reader used by inv_build                   */
+    u_int       ingest_depth;   /* Documents in flight (0 = INGEST_DEPTH) */
+};
+
+/* ─────────────────────────────────────────────
+ *  match_fn — Search result sink
+ *  Search modules report each matched word as the
+ *  list of its mNodes (several for a word spread
+ *  over shards) plus an edit distance (fuzzy only).
+ *  Return non-zero to stop the search.
+ * ───────────────────────────────────────────── */
+typedef int (*match_fn)(mNode **nodes, u_int nnodes, u_int dist, void *ctx);
+
+/* Receives each ranked document of top_docs; non-zero stops. */
+typedef int (*doc_fn)(const docEntry *doc, void *ctx);
+
 /* ─────────────────────────────────────────────
  *  Function Declarations
  * ───────────────────────────────────────────── */
 
 /* validation.c */
-Status read_and_validation(char *argv[], int i, Flist **head);
+Status read_and_validation(const char *fname, Flist **head);
 
 /* flist_utils.c */
-Status insert_at_last(Flist **head, char *fname);
-void   print_list(Flist *head);
+Status insert_at_last(Flist **head, const char *fname);
 void   free_list(Flist **head);
 
 /* hash_t_utils.c */
 void   initialize_hashTable(hash_T *arr);
+int    bucket_index(const char *word);
+mNode *bucket_find(const hash_T *bucket, const char *word, uint64_t hash, u_int len);
+mNode *bucket_append(hash_T *bucket, const char *word, uint64_t hash, u_int len);
 void   free_hash_table(hash_T *arr);
 
 /* create_database.c */
-Status create_database(hash_T *arr, Flist *head);
+Status create_database(hash_T *arr, Flist *head, IngestMode mode, u_int depth,
+                       docTable *docs, Flist **done);
+Status create_database_part(hash_T *arr, Flist *head, u_int nparts, u_int part);
+
+/* external_database.c */
+Status create_database_external(Flist *head, size_t budget, IngestMode mode, u_int depth,
+                                const char *out_path, u_int *runs);
+
+/* export_database.c */
+Status export_database(hash_T *arr, const docTable *docs, ExportFormat fmt, const char *path);
 
-/* display_database.c */
-void   display_database(hash_T *arr);
+/* analytics_database.c */
+Status top_terms(hash_T *arr, const docTable *docs, TermRank by, u_int n,
+                 match_fn fn, void *ctx);
+Status top_docs(const docTable *docs, DocRank by, u_int n, doc_fn fn, void *ctx);
+void   corpus_stats(hash_T *arr, const docTable *docs, corpusStats *cs);
+
+/* shard_database.c */
+Status build_shards(shardIndex *si, Flist *head, u_int nshards, ShardMode mode);
+Status search_shards(shardIndex *si, const char *word, u_int topk,
+                     match_fn fn, void *ctx, u_int *nmatched);
+void   free_shards(shardIndex *si);
 
 /* search_database.c */
-Status search_database(hash_T *arr, char *word);
+Status search_database(hash_T *arr, const char *word, match_fn fn, void *ctx);
 
-/* update_database.c */
-Status update_database(hash_T *arr, Flist **head, char **fileName, u_int fileCount);
+/* trigram_database.c */
+Status build_trigram_index(triIndex *ti, hash_T *arr);
+Status search_wildcard(triIndex *ti, hash_T *arr, const char *pattern, match_fn fn, void *ctx);
+void   free_trigram_index(triIndex *ti);
 
-/* save_database.c */
-Status save_database(hash_T *arr);
+/* fuzzy_database.c */
+Status build_fuzzy_index(fzIndex *fi, hash_T *arr);
+Status search_fuzzy(fzIndex *fi, hash_T *arr, const char *word, u_int max_dist,
+                    match_fn fn, void *ctx);
+void   free_fuzzy_index(fzIndex *fi);
 
 /* files_utils.c */
-void strip_punctuation(char *word);
+void     strip_punctuation(char *word);
+int      next_token(FILE *fp, char *word);
+uint64_t hash_word(const char *word);
+uint64_t hash_bytes(const void *data, size_t len, uint64_t seed);
+
+/* stream_utils.c */
+DocFormat document_format(const char *fname);
+int       document_supported(DocFormat fmt);
+FILE     *open_document(const char *fname);
+
+/* ingest_utils.c */
+int           ingest_uring_available(void);
+ingestReader *ingest_open(Flist *head, IngestMode mode, u_int depth, int hash);
+FILE         *ingest_next(ingestReader *br, Flist **file);
+Status        ingest_hash(const ingestReader *br, uint64_t *hash, size_t *len);
+const char   *ingest_buffer(const ingestReader *br, size_t *len);
+Status        ingest_close(ingestReader *br);
+
+/* dedup_utils.c */
+const char  *dedup_find(const docTable *dt, uint64_t hash, size_t len,
+                         const char *file_name, const char *buf);
+Status       dedup_add(docTable *dt, uint64_t hash, size_t len, const char *file_name,
+                       u_int ntokens, u_int nterms);
+Status       dedup_alias(docTable *dt, const char *original, const char *file_name);
+docEntry    *dedup_entry(const docTable *dt, const char *file_name);
+const Flist *dedup_aliases(const docTable *dt, const char *file_name);
+void         dedup_free(docTable *dt);
+
+/* ltable_utils.c */
+Status ltable_init(lTable *t);
+Status ltable_add(lTable *t, const char *word);
+size_t ltable_mem(const lTable *t);
+void   ltable_reset(lTable *t);
+void   ltable_free(lTable *t);
 
 #endif /* MAIN_H */
\ No newline at end of file
@@ -3,60 +3,42 @@
  * @brief  Case-insensitive word lookup across the inverted index.
  *
  * Computes the hash bucket from the word's first character, then
- * traverses the mNode chain using strcasecmp for case-insensitive
- * matching. If found, prints every file the word appears in along
- * with occurrence counts, then displays the total.
+ * traverses the mNode chain using strncasecmp for case-insensitive
+ * prefix matching. Every match is handed to the caller's match_fn,
+ * which decides how to present it.
  */
 
 #include "main.h"
 
 /**
- * @brief  Searches for a word in the hash table and prints the results.
+ * @brief  Reports every word in the hash table starting with a prefix.
  *
  * @param  arr   The 27-bucket hash table.
- * @param  word  The word to search for (case-insensitive).
+ * @param  word  The prefix to search for (case-insensitive).
+ * @param  fn    Receives each matching mNode; non-zero stops the search.
+ * @param  ctx   Passed through to fn.
  * @return SUCCESS if the word was found,
  *         DATA_NOT_FOUND if the word is not in the index.
  */
-#include "main.h"
-
-Status search_database(hash_T *arr, char *word)
+Status search_database(hash_T *arr, const char *word, match_fn fn, void *ctx)
 {
     /* ── Compute bucket index from first character ── */
-    int index;
-    if(word != NULL && islower(word[0]))
-        index = word[0] - 'a';
-    else if(word != NULL && isupper(word[0]))
-        index = word[0] - 'A';
-    else
-        index = 26;     /* Non-alphabetic token */
-
-    mNode *mTemp = arr[index].link;
+    mNode *mTemp = arr[bucket_index(word)].link;
     int search_len = strlen(word);
     int found_any = 0; // Flag to track if we found at least one match
 
     /* ── Traverse the ENTIRE mNode chain looking for prefix matches ── */
     while(mTemp != NULL)
     {
-        // Compare only up to the length of the search word
-        if(strncasecmp(mTemp->word, word, search_len) == 0)
+        // Compare only up to the length of the search word; a shorter
+        // word is rejected on its stored length alone
+        if(mTemp->len >= (u_int)search_len && strncasecmp(mTemp->word, word, search_len) == 0)
         {
             found_any = 1; // We found at least one!
-            
-            u_int word_count = 0;
-            sNode *sTemp = mTemp->sLink;
-
-            // Print the full matched word
-            printf("Found match: [" H_GREEN "%s" RESET "]\n", mTemp->word);
-
-            while(sTemp)
-            {
-                printf("  -> in %s : %d times\n", sTemp->file_name, sTemp->wordcount);
-                word_count += sTemp->wordcount;
-                sTemp = sTemp->subLink;
-            }
 
-            printf("  -> Total appearances: " H_MAGENTA "%d" RESET " Times\n\n", word_count);
+            // Hand the full matched word to the caller
+            if(fn(&mTemp, 1, 0, ctx))
+                break;
         }
         
         mTemp = mTemp->mLink; // Keep checking the rest of the bucket!
@@ -66,4 +48,4 @@ Status search_database(hash_T *arr, char *word)
         return DATA_NOT_FOUND;
 
     return SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,480 @@
+/**
+ * @file   shard_database.c
+ * @brief  Sharded index with parallel build and scatter-gather search.
+ *
+ * The index is split into N independent shards, each with its own 27-bucket
+ * hash table and built by its own thread:
+ *   - SHARD_BY_DOC  : files are dealt round-robin across shards. Each file
+ *                     is read once; a word may live in several shards.
+ *   - SHARD_BY_TERM : every shard reads every file but keeps only the terms
+ *                     with hash_word() % N == shard, so shards hold
+ *                     disjoint vocabularies.
+ *
+ * A search is scattered to one thread per shard, which collects and sorts
+ * its own prefix matches. The sorted lists are then gathered by a pairwise
+ * tree merge, each level's merges running in parallel, which folds the
+ * same word from different shards into one result. Only the final top-k
+ * cut (a bounded heap over the merged list) runs on the calling thread.
+ *
+ * Each thread allocates its own shard's nodes, so on NUMA machines a
+ * shard's memory is first-touched by the thread that builds it.
+ */
+
+#include <pthread.h>
+
+#include "main.h"
+
+#define SHARD_MERGE_PAR  4096   /* Matches from which merges run on threads */
+
+/* ─────────────────────────────────────────────
+ *  buildJob / searchJob — Per-thread work items
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    shard_T *shard;
+    Flist   *files;     /* Files to read for this shard            */
+    u_int    nparts;    /* Term partitions (1 in by-document mode) */
+    u_int    part;      /* Partition kept by this shard            */
+    Status   ret;
+} buildJob;
+
+/* ─────────────────────────────────────────────
+ *  shardHit — one gathered word
+ *  nodes[] are the word's mNodes across shards
+ *  (one per shard in by-document mode).
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    mNode **nodes;
+    u_int   nnodes;
+    u_int   filecount;
+    u_int   total;
+} shardHit;
+
+/* ─────────────────────────────────────────────
+ *  hitRun — Gathered words sorted by word
+ *  Every hit's nodes[] point into the run's own
+ *  pool; a run owns both arrays.
+ * ───────────────────────────────────────────── */
+typedef struct
+{
+    shardHit *hits;
+    size_t    nhits;
+    mNode   **pool;
+} hitRun;
+
+typedef struct
+{
+    shard_T    *shard;
+    const char *word;   /* Prefix to match (case-insensitive)   */
+    size_t      cap;    /* Capacity of run.pool while collecting */
+    hitRun      run;    /* This shard's matches on return       */
+    Status      ret;
+} searchJob;
+
+typedef struct
+{
+    hitRun *a, *b;      /* Inputs, freed by the merge  */
+    hitRun  out;
+    Status  ret;
+} mergeJob;
+
+/**
+ * @brief  Runs jobs[i] through fn on one thread each, joining them all.
+ *
+ * If a thread cannot be created, its job is run on the calling thread
+ * instead, so a failed pthread_create only costs parallelism.
+ */
+static void run_parallel(void *(*fn)(void *), void *jobs, size_t job_size, u_int n)
+{
+    pthread_t threads[SHARD_MAX];
+    int       started[SHARD_MAX];
+
+    for(u_int i = 0; i < n; i++)
+    {
+        void *job  = (char *)jobs + i * job_size;
+        started[i] = pthread_create(&threads[i], NULL, fn, job) == 0;
+        if(!started[i])
+            fn(job);
+    }
+    for(u_int i = 0; i < n; i++)
+        if(started[i])
+            pthread_join(threads[i], NULL);
+}
+
+static void *build_worker(void *arg)
+{
+    buildJob *job = arg;
+    job->ret = create_database_part(job->shard->table, job->files, job->nparts, job->part);
+    return NULL;
+}
+
+static int hit_cmp(const void *a, const void *b)
+{
+    return strcmp((*(mNode *const *)a)->word, (*(mNode *const *)b)->word);
+}
+
+static void free_run(hitRun *run)
+{
+    free(run->hits);
+    free(run->pool);
+    run->hits  = NULL;
+    run->pool  = NULL;
+    run->nhits = 0;
+}
+
+static void *search_worker(void *arg)
+{
+    searchJob *job = arg;
+    hitRun    *run = &job->run;
+    size_t     len = strlen(job->word);
+
+    job->ret = SUCCESS;
+    for(mNode *mTemp = job->shard->table[bucket_index(job->word)].link; mTemp; mTemp = mTemp->mLink)
+    {
+        if(mTemp->len < len || strncasecmp(mTemp->word, job->word, len) != 0)
+            continue;
+
+        if(run->nhits == job->cap)
+        {
+            size_t  new_cap = job->cap ? job->cap * 2 : 64;
+            mNode **grown   = realloc(run->pool, new_cap * sizeof(mNode *));
+            if(grown == NULL)
+            {
+                job->ret = FAILURE;
+                return NULL;
+            }
+            run->pool = grown;
+            job->cap  = new_cap;
+        }
+        run->pool[run->nhits++] = mTemp;
+    }
+
+    /* Sorting here keeps every gather step a linear merge */
+    if(run->nhits > 1)
+        qsort(run->pool, run->nhits, sizeof(mNode *), hit_cmp);
+
+    /* ── One single-node hit per match, totals counted on this thread ── */
+    run->hits = malloc((run->nhits ? run->nhits : 1) * sizeof(shardHit));
+    if(run->hits == NULL)
+    {
+        job->ret = FAILURE;
+        return NULL;
+    }
+    for(size_t i = 0; i < run->nhits; i++)
+    {
+        shardHit *hit = &run->hits[i];
+        hit->nodes     = &run->pool[i];
+        hit->nnodes    = 1;
+        hit->filecount = run->pool[i]->filecount;
+        hit->total     = 0;
+        for(sNode *sTemp = run->pool[i]->sLink; sTemp; sTemp = sTemp->subLink)
+            hit->total += sTemp->wordcount;
+    }
+    return NULL;
+}
+
+/* Appends hit to out, its nodes copied into out's pool */
+static void run_append(hitRun *out, size_t *used, const shardHit *hit)
+{
+    shardHit *dst = &out->hits[out->nhits++];
+    *dst       = *hit;
+    dst->nodes = &out->pool[*used];
+    memcpy(dst->nodes, hit->nodes, hit->nnodes * sizeof(mNode *));
+    *used += hit->nnodes;
+}
+
+/**
+ * @brief  Merges two word-sorted runs into one, folding a word present in
+ *         both into a single hit (a's nodes first). Frees both inputs.
+ */
+static void *merge_worker(void *arg)
+{
+    mergeJob *job = arg;
+    hitRun   *a = job->a, *b = job->b, *out = &job->out;
+    size_t    npool = 0, used = 0, i = 0, j = 0;
+
+    for(size_t k = 0; k < a->nhits; k++)
+        npool += a->hits[k].nnodes;
+    for(size_t k = 0; k < b->nhits; k++)
+        npool += b->hits[k].nnodes;
+
+    job->ret   = SUCCESS;
+    out->nhits = 0;
+    out->hits  = malloc((a->nhits + b->nhits ? a->nhits + b->nhits : 1) * sizeof(shardHit));
+    out->pool  = malloc((npool ? npool : 1) * sizeof(mNode *));
+    if(out->hits == NULL || out->pool == NULL)
+    {
+        free_run(out);
+        free_run(a);
+        free_run(b);
+        job->ret = FAILURE;
+        return NULL;
+    }
+
+    while(i < a->nhits || j < b->nhits)
+    {
+        int cmp = (i == a->nhits) ? 1 : (j == b->nhits) ? -1
+                : strcmp(a->hits[i].nodes[0]->word, b->hits[j].nodes[0]->word);
+        if(cmp < 0)
+            run_append(out, &used, &a->hits[i++]);
+        else if(cmp > 0)
+            run_append(out, &used, &b->hits[j++]);
+        else
+        {
+            /* Same word in both: b's nodes follow a's */
+            shardHit *hit = &out->hits[out->nhits];
+            run_append(out, &used, &a->hits[i]);
+            memcpy(&out->pool[used], b->hits[j].nodes, b->hits[j].nnodes * sizeof(mNode *));
+            used           += b->hits[j].nnodes;
+            hit->nnodes    += b->hits[j].nnodes;
+            hit->filecount += b->hits[j].filecount;
+            hit->total     += b->hits[j].total;
+            i++;
+            j++;
+        }
+    }
+
+    free_run(a);
+    free_run(b);
+    return NULL;
+}
+
+/**
+ * @brief  Builds nshards shards from the Flist, one thread per shard.
+ *
+ * Any previously built shards are freed first, and so are the new ones
+ * if any of them fails, leaving the index unbuilt.
+ *
+ * @param  si       Sharded index to (re)build.
+ * @param  head     Head of the Flist (files to index).
+ * @param  nshards  Number of shards, 1 .. SHARD_MAX.
+ * @param  mode     SHARD_BY_DOC or SHARD_BY_TERM.
+ * @return SUCCESS, or FAILURE if any shard failed to build.
+ */
+Status build_shards(shardIndex *si, Flist *head, u_int nshards, ShardMode mode)
+{
+    if(nshards == 0 || nshards > SHARD_MAX)
+        return FAILURE;
+
+    free_shards(si);
+    si->shards = calloc(nshards, sizeof(shard_T));
+    if(si->shards == NULL)
+        return FAILURE;
+    si->nshards = nshards;
+    si->mode    = mode;
+
+    /* ── Deal files to shards (by-document) ── */
+    u_int i = 0;
+    if(mode == SHARD_BY_DOC)
+        for(Flist *temp = head; temp; temp = temp->link, i++)
+            if(insert_at_last(&si->shards[i % nshards].files, temp->file_name) == FAILURE)
+            {
+                free_shards(si);
+                return FAILURE;
+            }
+
+    buildJob jobs[SHARD_MAX];
+    for(i = 0; i < nshards; i++)
+    {
+        shard_T *shard = &si->shards[i];
+        initialize_hashTable(shard->table);
+
+        jobs[i].shard  = shard;
+        jobs[i].files  = (mode == SHARD_BY_DOC) ? shard->files : head;
+        jobs[i].nparts = (mode == SHARD_BY_DOC) ? 1 : nshards;
+        jobs[i].part   = (mode == SHARD_BY_DOC) ? 0 : i;
+    }
+
+    run_parallel(build_worker, jobs, sizeof(buildJob), nshards);
+
+    /* A partly built index must not be searched */
+    for(i = 0; i < nshards; i++)
+        if(jobs[i].ret == FAILURE)
+        {
+            free_shards(si);
+            return FAILURE;
+        }
+    return SUCCESS;
+}
+
+/* ── Min-heap of hits by (total, then reverse word order) for top-k ── */
+static int hit_less(const shardHit *a, const shardHit *b)
+{
+    if(a->total != b->total)
+        return a->total < b->total;
+    return strcmp(a->nodes[0]->word, b->nodes[0]->word) > 0;
+}
+
+static void topk_sift_down(shardHit *heap, u_int n, u_int i)
+{
+    while(1)
+    {
+        u_int l = 2 * i + 1, r = l + 1, min = i;
+        if(l < n && hit_less(&heap[l], &heap[min])) min = l;
+        if(r < n && hit_less(&heap[r], &heap[min])) min = r;
+        if(min == i)
+            return;
+        shardHit tmp = heap[i]; heap[i] = heap[min]; heap[min] = tmp;
+        i = min;
+    }
+}
+
+static void topk_sift_up(shardHit *heap, u_int i)
+{
+    while(i > 0 && hit_less(&heap[i], &heap[(i - 1) / 2]))
+    {
+        shardHit tmp = heap[i]; heap[i] = heap[(i - 1) / 2]; heap[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+}
+
+static int hit_desc_cmp(const void *a, const void *b)
+{
+    const shardHit *x = a, *y = b;
+    return hit_less(x, y) - hit_less(y, x);
+}
+
+/**
+ * @brief  Prefix search across all shards in parallel.
+ *
+ * @param  si    A built sharded index.
+ * @param  word  Prefix to search for (case-insensitive).
+ * @param  topk  Report only the k words with the most occurrences, most
+ *               first (0 = every match, in alphabetical order).
+ * @param  fn    Receives each word's mNodes (one per shard holding it);
+ *               non-zero stops the search.
+ * @param  ctx   Passed through to fn.
+ * @param  nmatched  If not NULL, receives the number of distinct matching
+ *                   words before the top-k cut.
+ * @return SUCCESS if anything matched, DATA_NOT_FOUND if nothing did,
+ *         LIST_EMPTY if the shards were never built, FAILURE on malloc failure.
+ */
+Status search_shards(shardIndex *si, const char *word, u_int topk,
+                     match_fn fn, void *ctx, u_int *nmatched)
+{
+    if(si->nshards == 0)
+        return LIST_EMPTY;
+
+    u_int     n = si->nshards;
+    searchJob jobs[SHARD_MAX];
+    for(u_int i = 0; i < n; i++)
+    {
+        memset(&jobs[i], 0, sizeof(searchJob));
+        jobs[i].shard = &si->shards[i];
+        jobs[i].word  = word;
+    }
+
+    /* ── Scatter ── */
+    run_parallel(search_worker, jobs, sizeof(searchJob), n);
+
+    Status ret   = SUCCESS;
+    size_t total = 0;
+    hitRun runs[SHARD_MAX];
+    for(u_int i = 0; i < n; i++)
+    {
+        if(jobs[i].ret == FAILURE)
+            ret = FAILURE;
+        runs[i] = jobs[i].run;
+        total  += runs[i].nhits;
+    }
+
+    /* ── Gather: pairwise tree merge, one level at a time ──
+     * Pairs (0,1), (2,3), ... merge side by side; an odd run out moves up
+     * unchanged, so a word's nodes stay in shard order. */
+    u_int nruns = n;
+    while(ret == SUCCESS && nruns > 1)
+    {
+        mergeJob merges[SHARD_MAX / 2];
+        u_int    npairs = nruns / 2;
+        for(u_int p = 0; p < npairs; p++)
+        {
+            merges[p].a = &runs[2 * p];
+            merges[p].b = &runs[2 * p + 1];
+        }
+
+        /* Threads cost more than merging a short list */
+        if(total >= SHARD_MERGE_PAR)
+            run_parallel(merge_worker, merges, sizeof(mergeJob), npairs);
+        else
+            for(u_int p = 0; p < npairs; p++)
+                merge_worker(&merges[p]);
+
+        for(u_int p = 0; p < npairs; p++)
+        {
+            runs[p] = merges[p].out;
+            if(merges[p].ret == FAILURE)
+                ret = FAILURE;
+        }
+        if(nruns % 2)
+            runs[npairs] = runs[nruns - 1];
+        nruns = npairs + nruns % 2;
+    }
+
+    /* ── Keep everything, or only the k largest in a min-heap ── */
+    hitRun   *all   = &runs[0];
+    shardHit *heap  = NULL;
+    u_int     kept  = 0;
+    if(ret == SUCCESS && topk)
+    {
+        heap = malloc((topk < all->nhits ? topk : (all->nhits ? all->nhits : 1)) * sizeof(shardHit));
+        if(heap == NULL)
+            ret = FAILURE;
+    }
+    if(ret == SUCCESS && topk)
+    {
+        for(size_t i = 0; i < all->nhits; i++)
+        {
+            if(kept < topk)
+            {
+                heap[kept] = all->hits[i];
+                topk_sift_up(heap, kept);
+                kept++;
+            }
+            else if(hit_less(&heap[0], &all->hits[i]))
+            {
+                heap[0] = all->hits[i];
+                topk_sift_down(heap, kept, 0);
+            }
+        }
+        if(kept > 1)
+            qsort(heap, kept, sizeof(shardHit), hit_desc_cmp);
+    }
+
+    if(ret == SUCCESS)
+    {
+        shardHit *hits = topk ? heap : all->hits;
+        u_int     nout = topk ? kept : (u_int)all->nhits;
+        for(u_int i = 0; i < nout; i++)
+            if(fn(hits[i].nodes, hits[i].nnodes, 0, ctx))
+                break;
+
+        if(nmatched)
+            *nmatched = all->nhits;
+        if(all->nhits == 0)
+            ret = DATA_NOT_FOUND;
+    }
+
+    for(u_int i = 0; i < nruns; i++)
+        free_run(&runs[i]);
+    free(heap);
+    return ret;
+}
+
+/**
+ * @brief  Frees every shard's hash table and file list.
+ *
+ * Safe on a never-built (zeroed) shardIndex.
+ */
+void free_shards(shardIndex *si)
+{
+    for(u_int i = 0; i < si->nshards; i++)
+    {
+        free_hash_table(si->shards[i].table);
+        if(si->shards[i].files)
+            free_list(&si->shards[i].files);
+    }
+    free(si->shards);
+    si->shards  = NULL;
+    si->nshards = 0;
+}
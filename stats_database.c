@@ -0,0 +1,92 @@
+/**
+ * @file   stats_database.c
+ * @brief  Prints corpus statistics and top-N rankings (menu option 15).
+ *
+ * Everything comes from the analytics queries of the library (inv_stats,
+ * inv_top_terms, inv_top_docs), so no table is dumped or sorted here.
+ */
+
+#include "cli.h"
+
+#define STATS_RULE "________________________________________________________________________\n"
+
+/* ── Rank counter shared by the row printers ── */
+typedef struct
+{
+    unsigned int rank;
+} rankPrinter;
+
+static int print_term(const InvHit *hit, void *ctx)
+{
+    rankPrinter *p = ctx;
+    printf("| %-6u | " H_GREEN "%-30s" RESET " | %-12u | %-11u |\n",
+           ++p->rank, hit->word, hit->total, hit->filecount);
+    return 0;
+}
+
+static int print_doc(const InvDocStats *doc, void *ctx)
+{
+    rankPrinter *p = ctx;
+    printf("| %-6u | " H_MAGENTA "%-18s" RESET " | %-8u | %-8u | %-7.1f | %-6u |\n",
+           ++p->rank, doc->file_name, doc->terms, doc->tokens, doc->bytes / 1024.0, doc->aliases);
+    return 0;
+}
+
+static void print_top_terms(InvIndex *idx, unsigned int n, InvTermRank by, const char *title)
+{
+    rankPrinter printer = { 0 };
+
+    printf(H_CYAN "%s\n" RESET, title);
+    printf(BG_BLUE STATS_RULE RESET);
+    printf("| %-6s | %-30s | %-12s | %-11s |\n", "Rank", "Word", "WordCount", "FileCount");
+    if(inv_top_terms(idx, n, by, print_term, &printer) == INV_FAILURE)
+        printf(H_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+    printf(BG_BLUE STATS_RULE RESET);
+}
+
+/**
+ * @brief  Prints the index totals, the n most frequent words by
+ *         occurrences and by files, and the n documents with the most
+ *         distinct terms.
+ */
+void show_stats(InvIndex *idx, unsigned int n)
+{
+    InvStats stats;
+
+    if(inv_stats(idx, &stats) != INV_SUCCESS)
+        return;
+    if(stats.terms == 0)
+    {
+        printf(H_YELLOW "[Info] : Database is Empty\n" RESET);
+        return;
+    }
+
+    /* ── Totals ── */
+    printf(BG_BLUE STATS_RULE RESET);
+    printf("| %-20s : %-45u |\n", "Files", stats.files);
+    printf("| %-20s : %-45u |\n", "Distinct documents", stats.documents);
+    printf("| %-20s : %-45u |\n", "Aliases (copies)", stats.aliases);
+    printf("| %-20s : %-45u |\n", "Distinct words", stats.terms);
+    printf("| %-20s : %-45zu |\n", "Postings", stats.postings);
+    printf("| %-20s : %-45zu |\n", "Tokens", stats.tokens);
+    printf("| %-20s : %-45.2f |\n", "Text size (MB)", stats.bytes / (1024.0 * 1024.0));
+    if(stats.documents)
+        printf("| %-20s : %-45.1f |\n", "Tokens / document", (double)stats.tokens / stats.documents);
+    printf(BG_BLUE STATS_RULE RESET);
+
+    /* ── Rankings ── */
+    print_top_terms(idx, n, INV_TERMS_BY_TOTAL, "Most frequent words");
+    print_top_terms(idx, n, INV_TERMS_BY_FILES, "Most widespread words");
+
+    rankPrinter printer = { 0 };
+    printf(H_CYAN "Documents with the most distinct words\n" RESET);
+    printf(BG_BLUE STATS_RULE RESET);
+    printf("| %-6s | %-18s | %-8s | %-8s | %-7s | %-6s |\n",
+           "Rank", "File", "Terms", "Tokens", "Text KB", "Copies");
+    InvStatus ret = inv_top_docs(idx, n, INV_DOCS_BY_TERMS, print_doc, &printer);
+    if(ret == INV_NOT_FOUND)
+        printf("| " H_YELLOW "%-68s" RESET " |\n", "no per-document counts recorded");
+    else if(ret == INV_FAILURE)
+        printf(H_RED "[Error] : An Error has Occured in Dynamic Memory Allocation\n" RESET);
+    printf(BG_BLUE STATS_RULE RESET);
+}
@@ -0,0 +1,349 @@
+/**
+ * @file   stream_utils.c
+ * @brief  Opens plain and compressed documents as ordinary FILE streams.
+ *
+ * open_document() hides the on-disk format from the tokenizer:
+ *   - "name.txt"      → fopen
+ *   - "name.txt.gz"   → zlib
+ *   - "name.txt.zst"  → libzstd (only when built with HAVE_ZSTD)
+ *
+ * A compressed document is decoded by its own thread into a ring of
+ * STREAM_CHUNKS fixed-size chunks, and the returned FILE (glibc
+ * fopencookie) reads from that ring. The decoder runs ahead of the
+ * tokenizer by at most the ring size and then blocks. Memory is bounded
+ * and nothing is ever decompressed to disk.
+ *
+ * Callers that open the next document before tokenizing the current one
+ * (see ingest_utils.c) therefore decompress file i + 1 while file i is
+ * being tokenized.
+ */
+
+#define _GNU_SOURCE         /* fopencookie */
+
+#include <pthread.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "main.h"
+
+#define STREAM_CHUNKS      4            /* Decoded chunks buffered per document */
+#define STREAM_CHUNK_SIZE  (64 * 1024)
+
+/* ─────────────────────────────────────────────
+ *  docStream — One compressed document being decoded
+ *  The decoder thread fills ring slots at tail, the
+ *  reader drains them from head; count is shared.
+ * ───────────────────────────────────────────── */
+typedef struct docStream
+{
+    /* Decoder: fills buf with up to cap bytes; 0 = end, -1 = error */
+    ssize_t (*decode)(struct docStream *ds, char *buf, size_t cap);
+    void    (*finish)(struct docStream *ds);
+
+    gzFile   gz;
+#ifdef HAVE_ZSTD
+    FILE           *zfp;
+    ZSTD_DCtx      *zctx;
+    ZSTD_inBuffer   zin;
+    char           *zbuf;
+#endif
+
+    pthread_t        thread;
+    int              threaded;  /* 0 → decode inline on each read */
+    pthread_mutex_t  lock;
+    pthread_cond_t   cond;
+    char            *chunks[STREAM_CHUNKS];
+    size_t           len[STREAM_CHUNKS];
+    u_int            head;      /* Slot being read                   */
+    u_int            count;     /* Filled slots                      */
+    size_t           off;       /* Bytes of chunks[head] already read */
+    int              eof;       /* Decoder reached the end          */
+    int              error;     /* Decoder failed                   */
+    int              stop;      /* Reader closed early              */
+} docStream;
+
+/* ─────────────────────────────────────────────
+ *  Decoders
+ * ───────────────────────────────────────────── */
+
+static ssize_t gz_decode(docStream *ds, char *buf, size_t cap)
+{
+    int n = gzread(ds->gz, buf, (unsigned)cap);
+    int err;
+
+    /* A truncated file ends with Z_BUF_ERROR rather than a clean end */
+    if(n <= 0)
+    {
+        gzerror(ds->gz, &err);
+        return (n < 0 || err != Z_OK) ? -1 : 0;
+    }
+    return n;
+}
+
+static void gz_finish(docStream *ds)
+{
+    gzclose(ds->gz);
+}
+
+#ifdef HAVE_ZSTD
+static ssize_t zst_decode(docStream *ds, char *buf, size_t cap)
+{
+    ZSTD_outBuffer out = { buf, cap, 0 };
+
+    while(out.pos == 0)
+    {
+        if(ds->zin.pos == ds->zin.size)
+        {
+            ds->zin.size = fread(ds->zbuf, 1, ZSTD_DStreamInSize(), ds->zfp);
+            ds->zin.pos  = 0;
+            if(ds->zin.size == 0)
+                return ferror(ds->zfp) ? -1 : 0;
+        }
+        if(ZSTD_isError(ZSTD_decompressStream(ds->zctx, &out, &ds->zin)))
+            return -1;
+    }
+    return out.pos;
+}
+
+static void zst_finish(docStream *ds)
+{
+    ZSTD_freeDCtx(ds->zctx);
+    free(ds->zbuf);
+    if(ds->zfp)
+        fclose(ds->zfp);
+}
+#endif
+
+/* ─────────────────────────────────────────────
+ *  Decoder thread and cookie callbacks
+ * ───────────────────────────────────────────── */
+
+static void *decode_worker(void *arg)
+{
+    docStream *ds = arg;
+
+    while(1)
+    {
+        pthread_mutex_lock(&ds->lock);
+        while(ds->count == STREAM_CHUNKS && !ds->stop)
+            pthread_cond_wait(&ds->cond, &ds->lock);
+        if(ds->stop)
+        {
+            pthread_mutex_unlock(&ds->lock);
+            return NULL;
+        }
+        u_int slot = (ds->head + ds->count) % STREAM_CHUNKS;
+        pthread_mutex_unlock(&ds->lock);
+
+        /* The tail slot belongs to this thread until count covers it */
+        ssize_t n = ds->decode(ds, ds->chunks[slot], STREAM_CHUNK_SIZE);
+
+        pthread_mutex_lock(&ds->lock);
+        if(n > 0)
+        {
+            ds->len[slot] = n;
+            (ds->count)++;
+        }
+        else
+        {
+            ds->eof   = 1;
+            ds->error = n < 0;
+        }
+        pthread_cond_signal(&ds->cond);
+        pthread_mutex_unlock(&ds->lock);
+
+        if(n <= 0)
+            return NULL;
+    }
+}
+
+static ssize_t stream_read(void *cookie, char *buf, size_t size)
+{
+    docStream *ds = cookie;
+
+    if(!ds->threaded)
+        return ds->decode(ds, buf, size);
+
+    pthread_mutex_lock(&ds->lock);
+    while(ds->count == 0 && !ds->eof)
+        pthread_cond_wait(&ds->cond, &ds->lock);
+    if(ds->count == 0)
+    {
+        pthread_mutex_unlock(&ds->lock);
+        return ds->error ? -1 : 0;
+    }
+    u_int slot = ds->head;
+    pthread_mutex_unlock(&ds->lock);
+
+    /* The head slot belongs to the reader while count covers it */
+    size_t n = ds->len[slot] - ds->off;
+    if(n > size)
+        n = size;
+    memcpy(buf, ds->chunks[slot] + ds->off, n);
+    ds->off += n;
+
+    if(ds->off == ds->len[slot])
+    {
+        pthread_mutex_lock(&ds->lock);
+        ds->head = (ds->head + 1) % STREAM_CHUNKS;
+        ds->off  = 0;
+        (ds->count)--;
+        pthread_cond_signal(&ds->cond);
+        pthread_mutex_unlock(&ds->lock);
+    }
+    return n;
+}
+
+static void stream_free(docStream *ds)
+{
+    if(ds->finish)
+        ds->finish(ds);
+    for(int i = 0; i < STREAM_CHUNKS; i++)
+        free(ds->chunks[i]);
+    free(ds);
+}
+
+static int stream_close(void *cookie)
+{
+    docStream *ds = cookie;
+    int        ret;
+
+    if(ds->threaded)
+    {
+        pthread_mutex_lock(&ds->lock);
+        ds->stop = 1;
+        pthread_cond_signal(&ds->cond);
+        pthread_mutex_unlock(&ds->lock);
+        pthread_join(ds->thread, NULL);
+        pthread_mutex_destroy(&ds->lock);
+        pthread_cond_destroy(&ds->cond);
+    }
+
+    ret = ds->error ? EOF : 0;
+    stream_free(ds);
+    return ret;
+}
+
+/* ─────────────────────────────────────────────
+ *  Public helpers
+ * ───────────────────────────────────────────── */
+
+static int has_suffix(const char *name, const char *suffix)
+{
+    size_t n = strlen(name), s = strlen(suffix);
+    return n >= s && strcmp(name + n - s, suffix) == 0;
+}
+
+/**
+ * @brief  Classifies a document by its file name.
+ *
+ * @return DOC_PLAIN, DOC_GZIP or DOC_ZSTD for a ".txt", ".txt.gz" or
+ *         ".txt.zst" name, DOC_UNKNOWN for anything else.
+ */
+DocFormat document_format(const char *fname)
+{
+    if(has_suffix(fname, ".txt.gz"))
+        return DOC_GZIP;
+    if(has_suffix(fname, ".txt.zst"))
+        return DOC_ZSTD;
+    if(strstr(fname, ".txt") != NULL)
+        return DOC_PLAIN;
+    return DOC_UNKNOWN;
+}
+
+/**
+ * @brief  Whether this build can read the given format.
+ */
+int document_supported(DocFormat fmt)
+{
+#ifdef HAVE_ZSTD
+    return fmt != DOC_UNKNOWN;
+#else
+    return fmt != DOC_UNKNOWN && fmt != DOC_ZSTD;
+#endif
+}
+
+/**
+ * @brief  Opens a document for reading as decompressed text.
+ *
+ * For a compressed document the decoder thread starts immediately, so
+ * opening the next file early overlaps its decompression with whatever
+ * the caller does meanwhile. Close with fclose as usual; a decoding
+ * error shows up as ferror() on the stream.
+ *
+ * @return The stream, or NULL if the file cannot be opened, its format
+ *         is not supported by this build, or allocation fails.
+ */
+FILE *open_document(const char *fname)
+{
+    DocFormat fmt = document_format(fname);
+    if(!document_supported(fmt))
+        return NULL;
+    if(fmt == DOC_PLAIN)
+        return fopen(fname, "r");
+
+    docStream *ds = calloc(1, sizeof(docStream));
+    if(ds == NULL)
+        return NULL;
+
+    if(fmt == DOC_GZIP)
+    {
+        ds->gz = gzopen(fname, "rb");
+        if(ds->gz == NULL)
+        {
+            free(ds);
+            return NULL;
+        }
+        gzbuffer(ds->gz, STREAM_CHUNK_SIZE);
+        ds->decode = gz_decode;
+        ds->finish = gz_finish;
+    }
+#ifdef HAVE_ZSTD
+    else
+    {
+        ds->decode = zst_decode;
+        ds->finish = zst_finish;
+        ds->zfp    = fopen(fname, "rb");
+        ds->zctx   = ZSTD_createDCtx();
+        ds->zbuf   = malloc(ZSTD_DStreamInSize());
+        ds->zin.src = ds->zbuf;
+        if(ds->zfp == NULL || ds->zctx == NULL || ds->zbuf == NULL)
+        {
+            stream_free(ds);
+            return NULL;
+        }
+    }
+#endif
+
+    for(int i = 0; i < STREAM_CHUNKS; i++)
+    {
+        ds->chunks[i] = malloc(STREAM_CHUNK_SIZE);
+        if(ds->chunks[i] == NULL)
+        {
+            stream_free(ds);
+            return NULL;
+        }
+    }
+
+    cookie_io_functions_t io = { stream_read, NULL, NULL, stream_close };
+    FILE *fp = fopencookie(ds, "r", io);
+    if(fp == NULL)
+    {
+        stream_free(ds);
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, STREAM_CHUNK_SIZE);  /* One ring chunk per refill */
+
+    /* Without a thread the stream still works, just without read-ahead */
+    pthread_mutex_init(&ds->lock, NULL);
+    pthread_cond_init(&ds->cond, NULL);
+    ds->threaded = pthread_create(&ds->thread, NULL, decode_worker, ds) == 0;
+    if(!ds->threaded)
+    {
+        pthread_mutex_destroy(&ds->lock);
+        pthread_cond_destroy(&ds->cond);
+    }
+    return fp;
+}
@@ -0,0 +1,341 @@
+/**
+ * @file   trigram_database.c
+ * @brief  Trigram index for wildcard, substring and suffix search.
+ *
+ * search_database only handles prefixes, and only within one bucket. A
+ * pattern such as "*tion" or "emb*ed" could start with any letter, so a
+ * naive lookup scans the whole vocabulary. Instead, every word is
+ * lower-cased, padded as  TRI_BEGIN word TRI_END , and each 3-byte window
+ * is recorded in a posting list of word ids:
+ *
+ *     "bed"  →  ^be  bed  ed$
+ *
+ * A pattern is padded the same way (only at the ends not opened by '*'),
+ * split on its wildcards, and the trigrams of each literal piece are
+ * looked up. Intersecting those posting lists leaves a small candidate
+ * set, which is then verified with a real glob match before being
+ * reported. Patterns with no literal run of 3+ bytes fall back to a
+ * vocabulary scan.
+ *
+ * The index is a snapshot: it is marked stale when the hash table changes
+ * and rebuilt lazily by the next wildcard search.
+ */
+
+#include "main.h"
+
+#define TRI_BEGIN       '\x01'  /* Pads the start of a word / anchored pattern */
+#define TRI_END         '\x02'  /* Pads the end of a word / anchored pattern   */
+#define TRI_INIT_SLOTS  1024
+
+#define TRI_KEY(s) (((uint32_t)(unsigned char)(s)[0] << 16) | \
+                    ((uint32_t)(unsigned char)(s)[1] << 8)  | \
+                     (uint32_t)(unsigned char)(s)[2])
+
+static u_int tri_slot(uint32_t key, u_int mask)
+{
+    return (key * 2654435761u) & mask;      /* Knuth multiplicative hash */
+}
+
+/**
+ * @brief  Finds the posting list for key, or NULL if no word has it.
+ */
+static triPost *tri_find(triIndex *ti, uint32_t key)
+{
+    u_int mask = ti->nslots - 1;
+    for(u_int pos = tri_slot(key, mask); ti->posts[pos].key; pos = (pos + 1) & mask)
+        if(ti->posts[pos].key == key)
+            return &ti->posts[pos];
+    return NULL;
+}
+
+static Status tri_grow(triIndex *ti)
+{
+    u_int    new_slots = ti->nslots * 2;
+    u_int    mask      = new_slots - 1;
+    triPost *grown     = calloc(new_slots, sizeof(triPost));
+    if(grown == NULL)
+        return FAILURE;
+
+    for(u_int i = 0; i < ti->nslots; i++)
+    {
+        if(ti->posts[i].key == 0)
+            continue;
+        u_int pos = tri_slot(ti->posts[i].key, mask);
+        while(grown[pos].key)
+            pos = (pos + 1) & mask;
+        grown[pos] = ti->posts[i];
+    }
+
+    free(ti->posts);
+    ti->posts  = grown;
+    ti->nslots = new_slots;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Adds word id to key's posting list (once per word).
+ */
+static Status tri_add(triIndex *ti, uint32_t key, u_int id)
+{
+    if(2 * (ti->nposts + 1) > ti->nslots && tri_grow(ti) == FAILURE)
+        return FAILURE;
+
+    u_int mask = ti->nslots - 1;
+    u_int pos  = tri_slot(key, mask);
+    while(ti->posts[pos].key && ti->posts[pos].key != key)
+        pos = (pos + 1) & mask;
+
+    triPost *post = &ti->posts[pos];
+    if(post->key == 0)
+    {
+        post->key = key;
+        (ti->nposts)++;
+    }
+
+    /* Ids arrive in ascending order — a repeat can only be the last one */
+    if(post->nids && post->ids[post->nids - 1] == id)
+        return SUCCESS;
+
+    if(post->nids == post->cap)
+    {
+        u_int  new_cap = post->cap ? post->cap * 2 : 4;
+        u_int *ids     = realloc(post->ids, new_cap * sizeof(u_int));
+        if(ids == NULL)
+            return FAILURE;
+        post->ids = ids;
+        post->cap = new_cap;
+    }
+    post->ids[post->nids++] = id;
+    return SUCCESS;
+}
+
+/**
+ * @brief  Case-insensitive glob match supporting '*' (any run) and '?' (one byte).
+ *
+ * @param  pat   Lower-cased pattern.
+ * @param  word  Word to test.
+ */
+static int glob_match(const char *pat, const char *word)
+{
+    const char *star = NULL, *retry = NULL;
+
+    while(*word)
+    {
+        if(*pat == '?' || *pat == tolower((unsigned char)*word))
+        {
+            pat++;
+            word++;
+        }
+        else if(*pat == '*')
+        {
+            star  = pat++;          /* Remember the star, try matching nothing */
+            retry = word;
+        }
+        else if(star)
+        {
+            pat  = star + 1;        /* Let the last star absorb one more byte */
+            word = ++retry;
+        }
+        else
+            return 0;
+    }
+    while(*pat == '*')
+        pat++;
+    return *pat == '\0';
+}
+
+/**
+ * @brief  Snapshots every word in the hash table and indexes its trigrams.
+ *
+ * @param  ti   Trigram index (any previous contents are freed).
+ * @param  arr  The 27-bucket hash table.
+ * @return SUCCESS, or FAILURE on malloc failure.
+ */
+Status build_trigram_index(triIndex *ti, hash_T *arr)
+{
+    free_trigram_index(ti);
+
+    u_int nwords = 0;
+    for(int i = 0; i < 27; i++)
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
+            nwords++;
+
+    ti->words  = malloc((nwords ? nwords : 1) * sizeof(mNode *));
+    ti->posts  = calloc(TRI_INIT_SLOTS, sizeof(triPost));
+    ti->nslots = TRI_INIT_SLOTS;
+    if(ti->words == NULL || ti->posts == NULL)
+    {
+        free_trigram_index(ti);
+        return FAILURE;
+    }
+
+    char padded[WORD_BUF_SIZE + 2];
+    for(int i = 0; i < 27; i++)
+    {
+        for(mNode *mTemp = arr[i].link; mTemp; mTemp = mTemp->mLink)
+        {
+            u_int id = ti->nwords++;
+            ti->words[id] = mTemp;
+
+            /* ── TRI_BEGIN + lower-cased word + TRI_END ── */
+            size_t len = 0;
+            padded[len++] = TRI_BEGIN;
+            for(const char *c = mTemp->word; *c && len < WORD_BUF_SIZE; c++)
+                padded[len++] = tolower((unsigned char)*c);
+            padded[len++] = TRI_END;
+
+            for(size_t k = 0; k + 3 <= len; k++)
+            {
+                if(tri_add(ti, TRI_KEY(padded + k), id) == FAILURE)
+                {
+                    free_trigram_index(ti);
+                    return FAILURE;
+                }
+            }
+        }
+    }
+
+    ti->stale = 0;
+    return SUCCESS;
+}
+
+static int post_len_cmp(const void *a, const void *b)
+{
+    u_int x = (*(triPost *const *)a)->nids, y = (*(triPost *const *)b)->nids;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  Reports every word matching a wildcard or substring pattern.
+ *
+ * Patterns use '*' (any run of characters) and '?' (exactly one). A
+ * pattern with no wildcard is a substring search, i.e. "bed" == "*bed*".
+ * Matching is case-insensitive. The trigram index is rebuilt first if
+ * the hash table changed since it was built.
+ *
+ * @param  ti       Trigram index.
+ * @param  arr      The 27-bucket hash table it indexes.
+ * @param  pattern  Pattern to match.
+ * @param  fn       Receives each matching mNode; non-zero stops the search.
+ * @param  ctx      Passed through to fn.
+ * @return SUCCESS if anything matched, DATA_NOT_FOUND otherwise,
+ *         FAILURE on malloc failure.
+ */
+Status search_wildcard(triIndex *ti, hash_T *arr, const char *pattern, match_fn fn, void *ctx)
+{
+    if((ti->stale || ti->posts == NULL) && build_trigram_index(ti, arr) == FAILURE)
+        return FAILURE;
+
+    /* ── Normalise: lower-case, and wrap a plain word as *word* ── */
+    char pat[WORD_BUF_SIZE + 2];
+    int  wild = strpbrk(pattern, "*?") != NULL;
+    size_t plen = 0;
+    if(!wild)
+        pat[plen++] = '*';
+    for(const char *c = pattern; *c && plen < WORD_BUF_SIZE; c++)
+        pat[plen++] = tolower((unsigned char)*c);
+    if(!wild)
+        pat[plen++] = '*';
+    pat[plen] = '\0';
+
+    /* ── Pad the anchored ends the same way words were padded ── */
+    char padded[WORD_BUF_SIZE + 4];
+    size_t len = 0;
+    if(pat[0] != '*')
+        padded[len++] = TRI_BEGIN;
+    memcpy(padded + len, pat, plen);
+    len += plen;
+    if(pat[plen - 1] != '*')
+        padded[len++] = TRI_END;
+
+    /* ── Posting list of every trigram inside a literal run ── */
+    triPost **lists  = malloc((len ? len : 1) * sizeof(triPost *));
+    u_int     nlists = 0;
+    if(lists == NULL)
+        return FAILURE;
+
+    for(size_t k = 0; k + 3 <= len; k++)
+    {
+        if(memchr(padded + k, '*', 3) || memchr(padded + k, '?', 3))
+            continue;
+        triPost *post = tri_find(ti, TRI_KEY(padded + k));
+        if(post == NULL)
+        {
+            free(lists);            /* A required trigram occurs nowhere */
+            return DATA_NOT_FOUND;
+        }
+        lists[nlists++] = post;
+    }
+
+    /* ── Intersect, smallest list first; no trigrams → every word ── */
+    u_int *cand  = NULL;
+    u_int  ncand = 0;
+    if(nlists)
+    {
+        qsort(lists, nlists, sizeof(triPost *), post_len_cmp);
+        cand = malloc(lists[0]->nids * sizeof(u_int));
+        if(cand == NULL)
+        {
+            free(lists);
+            return FAILURE;
+        }
+        memcpy(cand, lists[0]->ids, lists[0]->nids * sizeof(u_int));
+        ncand = lists[0]->nids;
+
+        for(u_int l = 1; l < nlists && ncand; l++)
+        {
+            u_int i = 0, j = 0, out = 0;
+            while(i < ncand && j < lists[l]->nids)
+            {
+                if(cand[i] < lists[l]->ids[j])      i++;
+                else if(cand[i] > lists[l]->ids[j]) j++;
+                else { cand[out++] = cand[i]; i++; j++; }
+            }
+            ncand = out;
+        }
+    }
+    else
+    {
+        cand = malloc((ti->nwords ? ti->nwords : 1) * sizeof(u_int));
+        if(cand == NULL)
+        {
+            free(lists);
+            return FAILURE;
+        }
+        for(u_int i = 0; i < ti->nwords; i++)
+            cand[ncand++] = i;
+    }
+
+    /* ── Verify candidates and hand them to the caller ── */
+    u_int found = 0;
+    for(u_int i = 0; i < ncand; i++)
+    {
+        mNode *node = ti->words[cand[i]];
+        if(glob_match(pat, node->word))
+        {
+            found++;
+            if(fn(&node, 1, 0, ctx))
+                break;
+        }
+    }
+
+    free(cand);
+    free(lists);
+    return found ? SUCCESS : DATA_NOT_FOUND;
+}
+
+/**
+ * @brief  Frees the trigram index and marks it for rebuild.
+ */
+void free_trigram_index(triIndex *ti)
+{
+    if(ti->posts)
+        for(u_int i = 0; i < ti->nslots; i++)
+            free(ti->posts[i].ids);
+    free(ti->posts);
+    free(ti->words);
+    ti->posts  = NULL;
+    ti->words  = NULL;
+    ti->nwords = ti->nslots = ti->nposts = 0;
+    ti->stale  = 1;
+}
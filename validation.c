@@ -9,58 +9,51 @@
  * traversal to a single loop comparing each node against fname.
  */
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "main.h"
 
 /**
  * @brief  Validates a filename and, if valid, appends it to the Flist.
  *
  * Checks (in order):
- *   1. The file has a ".txt" extension.
- *   2. The file can be opened (exists and is accessible).
+ *   1. The file is a ".txt" document, possibly compressed as ".txt.gz"
+ *      or ".txt.zst", in a format this build can decode.
+ *   2. The file is a readable regular file.
  *   3. The file is not empty.
  *   4. The filename is not already in the Flist (duplicate check).
  *
- * @param  argv  Argument vector (or any string array).
- * @param  i     Index into argv for the filename to validate.
- * @param  head  Pointer-to-pointer to the Flist head.
+ * Checks 2 and 3 use stat/access rather than opening the file, so adding
+ * many documents costs no open/close pair per file.
+ *
+ * Nothing is printed — the caller reports the returned reason.
+ *
+ * @param  fname  Filename to validate.
+ * @param  head   Pointer-to-pointer to the Flist head.
  * @return SUCCESS if the file passes all checks and was inserted,
- *         FAILURE otherwise (reason is printed to stdout).
+ *         NOT_TXT_FILE, UNSUPPORTED, FILE_NOT_OPEN, FILE_EMPTY or
+ *         DUPLICATE for the failed check, FAILURE if the insertion could not allocate.
  */
-Status read_and_validation(char *argv[], int i, Flist **head)
+Status read_and_validation(const char *fname, Flist **head)
 {
-    FILE *fp;
-
-    /* Check for .txt extension */
-    if(strstr(argv[i], ".txt") != NULL)
-    {
-        /* Check the file can be opened */
-        fp = fopen(argv[i], "r");
-        if(fp == NULL)
-            return FAILURE;
+    struct stat st;
 
-        /* Check the file is not empty */
-        fseek(fp, 0, SEEK_END);
-        if(ftell(fp) == 0)
-        {
-            printf(H_RED "%s file is empty\n" RESET, argv[i]);
-            fclose(fp);
-            return FAILURE;
-        }
+    /* Check for a .txt document in a readable encoding */
+    DocFormat fmt = document_format(fname);
+    if(fmt == DOC_UNKNOWN)
+        return NOT_TXT_FILE;
+    if(!document_supported(fmt))
+        return UNSUPPORTED;
 
-        fclose(fp);
+    /* Check the file exists, is a regular file and can be read */
+    if(stat(fname, &st) != 0 || !S_ISREG(st.st_mode) || access(fname, R_OK) != 0)
+        return FILE_NOT_OPEN;
 
-        /* Attempt insertion — insert_at_last handles duplicate detection */
-        if(insert_at_last(head, argv[i]) == FAILURE)
-        {
-            printf(H_YELLOW "[Info] : %s's Duplicate Found\n" RESET, argv[i]);
-            return FAILURE;
-        }
-    }
-    else
-    {
-        printf(H_RED "[Info] : %s is not a .txt file\n" RESET, argv[i]);
-        return FAILURE;
-    }
+    /* Check the file is not empty */
+    if(st.st_size == 0)
+        return FILE_EMPTY;
 
-    return SUCCESS;
-}
\ No newline at end of file
+    /* Attempt insertion — insert_at_last handles duplicate detection */
+    return insert_at_last(head, fname);
+}